@@ -0,0 +1,58 @@
+#ifndef NC_BUFFER_HH
+#define NC_BUFFER_HH
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_buf_alloc
+//memory of variable buffers, aligned to nc_buf_align bytes (a cache line, the widest SIMD load);
+//buffers of nc_buf_huge_size bytes or more are aligned to nc_buf_huge_size and advised to use
+//transparent huge pages (Linux), which saves TLB misses when a large variable is scanned;
+//freed with nc_buf_free
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_buf_align = 64; //bytes
+const size_t nc_buf_huge_size = 2 * 1024 * 1024; //bytes, size of a huge page
+
+inline void* nc_buf_alloc(size_t size, bool zero)
+{
+  void *buf = NULL;
+  size = (size == 0) ? nc_buf_align : size;
+#ifdef _WIN32
+  buf = _aligned_malloc(size, nc_buf_align);
+#else
+  size_t align = (size >= nc_buf_huge_size) ? nc_buf_huge_size : nc_buf_align;
+  if (posix_memalign(&buf, align, size) != 0)
+  {
+    return NULL;
+  }
+#if defined(MADV_HUGEPAGE)
+  if (align == nc_buf_huge_size)
+  {
+    madvise(buf, size - size % nc_buf_huge_size, MADV_HUGEPAGE);
+  }
+#endif
+#endif
+  if (buf != NULL && zero)
+  {
+    memset(buf, 0, size);
+  }
+  return buf;
+}
+
+inline void nc_buf_free(void *buf)
+{
+#ifdef _WIN32
+  _aligned_free(buf);
+#else
+  free(buf);
+#endif
+}
+
+#endif
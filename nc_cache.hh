@@ -0,0 +1,149 @@
+#ifndef NC_CACHE_HH
+#define NC_CACHE_HH
+
+#include <list>
+#include <map>
+#include "nc_data.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nccache_t
+//least recently used cache of variable data buffers, bounded by a memory budget (bytes)
+//a buffer used by an open view is pinned and never evicted; evicted buffers are released 
+//(m_buf set to NULL) and read again from file on demand; other data held under the same budget
+//(tiles) is charged to it
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class nccache_t
+{
+public:
+  nccache_t(size_t budget) :
+    m_budget(budget),
+    m_resident(0),
+    m_nbr_hit(0),
+    m_nbr_miss(0)
+  {
+  }
+
+  //buffer of ncvar was just read from file
+  void insert(ncvar_t *ncvar)
+  {
+    entry_t &entry = find(ncvar);
+    m_resident -= entry.m_size;
+    entry.m_size = ncvar->size() * ncvar->type_size();
+    m_resident += entry.m_size;
+    m_nbr_miss++;
+  }
+
+  //buffer of ncvar is resident and is used again
+  void touch(ncvar_t *ncvar)
+  {
+    find(ncvar);
+    m_nbr_hit++;
+  }
+
+  //a view uses the buffer of ncvar, do not evict
+  void pin(ncvar_t *ncvar)
+  {
+    find(ncvar).m_nbr_pin++;
+  }
+
+  void unpin(ncvar_t *ncvar)
+  {
+    std::map<ncvar_t*, std::list<entry_t>::iterator>::iterator it = m_index.find(ncvar);
+    if (it != m_index.end() && it->second->m_nbr_pin > 0)
+    {
+      it->second->m_nbr_pin--;
+    }
+  }
+
+  //ncvar is deleted, stop tracking it
+  void erase(ncvar_t *ncvar)
+  {
+    std::map<ncvar_t*, std::list<entry_t>::iterator>::iterator it = m_index.find(ncvar);
+    if (it == m_index.end())
+    {
+      return;
+    }
+    m_resident -= it->second->m_size;
+    m_lru.erase(it->second);
+    m_index.erase(it);
+  }
+
+  //release least recently used, unpinned buffers until resident size is within budget
+  void trim()
+  {
+    std::list<entry_t>::iterator it = m_lru.end();
+    while (m_resident > m_budget && it != m_lru.begin())
+    {
+      --it;
+      if (it->m_nbr_pin > 0)
+      {
+        continue;
+      }
+      m_resident -= it->m_size;
+      it->m_ncvar->release();
+      m_index.erase(it->m_ncvar);
+      it = m_lru.erase(it);
+    }
+  }
+
+  //size bytes of other data are resident, release buffers to make room
+  void charge(size_t size)
+  {
+    m_resident += size;
+    trim();
+  }
+
+  //size bytes of other data were released
+  void discharge(size_t size)
+  {
+    m_resident -= size;
+  }
+
+  void set_budget(size_t budget)
+  {
+    m_budget = budget;
+    trim();
+  }
+
+  size_t m_budget; // memory budget (bytes)
+  size_t m_resident; // bytes of resident buffers and charged data
+  size_t m_nbr_hit; // number of requests for a resident buffer
+  size_t m_nbr_miss; // number of requests that needed a read from file
+
+protected:
+  class entry_t
+  {
+  public:
+    entry_t(ncvar_t *ncvar) :
+      m_ncvar(ncvar),
+      m_size(0),
+      m_nbr_pin(0)
+    {
+    }
+    ncvar_t *m_ncvar;
+    size_t m_size; // bytes resident (0 if not loaded)
+    int m_nbr_pin; // number of open views using the buffer
+  };
+
+  //get entry for ncvar (created if needed) and make it the most recently used
+  entry_t& find(ncvar_t *ncvar)
+  {
+    std::map<ncvar_t*, std::list<entry_t>::iterator>::iterator it = m_index.find(ncvar);
+    if (it == m_index.end())
+    {
+      m_lru.push_front(entry_t(ncvar));
+      m_index[ncvar] = m_lru.begin();
+    }
+    else
+    {
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+    }
+    return m_lru.front();
+  }
+
+  std::list<entry_t> m_lru; // most recently used first
+  std::map<ncvar_t*, std::list<entry_t>::iterator> m_index;
+};
+
+#endif
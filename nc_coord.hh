@@ -0,0 +1,109 @@
+#ifndef NC_COORD_HH
+#define NC_COORD_HH
+
+#include <map>
+#include "nc_data.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nccoord_t
+//coordinate variables shared by the variables of a group: one ncvar_t (and one buffer) per
+//(file, group, dimension), reference counted by the items that use it; names are interned, so keys
+//compare addresses
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class nccoord_t
+{
+public:
+  nccoord_t()
+  {
+  }
+
+  //coordinate variable of a dimension, NULL if not yet defined; a reference is added if found
+  ncvar_t* acquire(const char *file_name, const char *grp_nm_fll, const char *dmn_nm)
+  {
+    std::map<key_t, entry_t>::iterator it = m_coord.find(key_t(file_name, grp_nm_fll, dmn_nm));
+    if (it == m_coord.end())
+    {
+      return NULL;
+    }
+    it->second.m_nbr_ref++;
+    return it->second.m_ncvar;
+  }
+
+  //store a new coordinate variable, with one reference
+  void insert(const char *file_name, const char *grp_nm_fll, const char *dmn_nm, ncvar_t *ncvar)
+  {
+    key_t key(file_name, grp_nm_fll, dmn_nm);
+    m_coord[key] = entry_t(ncvar);
+    m_index[ncvar] = key;
+  }
+
+  //remove a reference; true if it was the last one and ncvar is to be deleted by the caller
+  bool release(ncvar_t *ncvar)
+  {
+    std::map<ncvar_t*, key_t>::iterator it_idx = m_index.find(ncvar);
+    if (it_idx == m_index.end())
+    {
+      return true;
+    }
+    std::map<key_t, entry_t>::iterator it = m_coord.find(it_idx->second);
+    if (--it->second.m_nbr_ref > 0)
+    {
+      return false;
+    }
+    m_coord.erase(it);
+    m_index.erase(it_idx);
+    return true;
+  }
+
+  //number of coordinate variables
+  size_t size() const
+  {
+    return m_coord.size();
+  }
+
+protected:
+  class key_t
+  {
+  public:
+    key_t() : m_file_name(NULL), m_grp_nm_fll(NULL), m_dmn_nm(NULL)
+    {
+    }
+    key_t(const char *file_name, const char *grp_nm_fll, const char *dmn_nm) :
+      m_file_name(file_name),
+      m_grp_nm_fll(grp_nm_fll),
+      m_dmn_nm(dmn_nm)
+    {
+    }
+    bool operator<(const key_t &key) const
+    {
+      if (m_file_name != key.m_file_name)
+      {
+        return m_file_name < key.m_file_name;
+      }
+      if (m_grp_nm_fll != key.m_grp_nm_fll)
+      {
+        return m_grp_nm_fll < key.m_grp_nm_fll;
+      }
+      return m_dmn_nm < key.m_dmn_nm;
+    }
+    const char *m_file_name;
+    const char *m_grp_nm_fll;
+    const char *m_dmn_nm;
+  };
+  class entry_t
+  {
+  public:
+    entry_t(ncvar_t *ncvar = NULL) :
+      m_ncvar(ncvar),
+      m_nbr_ref(1)
+    {
+    }
+    ncvar_t *m_ncvar;
+    int m_nbr_ref; // number of items using m_ncvar
+  };
+  std::map<key_t, entry_t> m_coord;
+  std::map<ncvar_t*, key_t> m_index; // key of each coordinate variable
+};
+
+#endif
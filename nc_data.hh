@@ -3,82 +3,585 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <thread>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <netcdf.h>
+#include "nc_intern.hh"
+#include "nc_buffer.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_visit
+//call visitor(buf) with buf cast to a pointer to the C type of a netCDF atomic type; this is the only
+//place where netCDF types are mapped to C types; a visitor has a template operator() instantiated for 
+//each type, so that its loops are compiled for the element type (and can be vectorized), and 
+//optional overloads for types that need different code (NC_STRING is char*, NC_CHAR is char)
+//returns false for types that are not atomic
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, typename B>
+struct ncptr_t
+{
+  typedef T* type;
+};
+
+template <typename T>
+struct ncptr_t<T, const void>
+{
+  typedef const T* type;
+};
+
+template <typename V, typename B>
+inline bool nc_visit(const nc_type nc_typ, B *buf, V &visitor)
+{
+  switch (nc_typ)
+  {
+  case NC_FLOAT:
+    visitor(static_cast<typename ncptr_t<float, B>::type>(buf));
+    return true;
+  case NC_DOUBLE:
+    visitor(static_cast<typename ncptr_t<double, B>::type>(buf));
+    return true;
+  case NC_INT:
+    visitor(static_cast<typename ncptr_t<int, B>::type>(buf));
+    return true;
+  case NC_SHORT:
+    visitor(static_cast<typename ncptr_t<short, B>::type>(buf));
+    return true;
+  case NC_CHAR:
+    visitor(static_cast<typename ncptr_t<char, B>::type>(buf));
+    return true;
+  case NC_BYTE:
+    visitor(static_cast<typename ncptr_t<signed char, B>::type>(buf));
+    return true;
+  case NC_UBYTE:
+    visitor(static_cast<typename ncptr_t<unsigned char, B>::type>(buf));
+    return true;
+  case NC_USHORT:
+    visitor(static_cast<typename ncptr_t<unsigned short, B>::type>(buf));
+    return true;
+  case NC_UINT:
+    visitor(static_cast<typename ncptr_t<unsigned int, B>::type>(buf));
+    return true;
+  case NC_INT64:
+    visitor(static_cast<typename ncptr_t<long long, B>::type>(buf));
+    return true;
+  case NC_UINT64:
+    visitor(static_cast<typename ncptr_t<unsigned long long, B>::type>(buf));
+    return true;
+  case NC_STRING:
+    visitor(static_cast<typename ncptr_t<char*, B>::type>(buf));
+    return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_type_size
+//size in bytes of one element of a netCDF atomic type
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncsizeof_t
+{
+public:
+  ncsizeof_t() : m_size(0)
+  {
+  }
+  template <typename T>
+  void operator()(const T *)
+  {
+    m_size = sizeof(T);
+  }
+  size_t m_size;
+};
+
+inline size_t nc_type_size(const nc_type nc_typ)
+{
+  ncsizeof_t visitor;
+  nc_visit(nc_typ, static_cast<const void*>(NULL), visitor);
+  return visitor.m_size;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_copy_be
+//copy nbr elements of size bytes stored big-endian (as in classic format files) to native order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline bool nc_is_little_endian()
+{
+  const uint16_t one = 1;
+  unsigned char byte;
+  memcpy(&byte, &one, 1);
+  return byte == 1;
+}
+
+inline uint16_t nc_bswap(uint16_t val)
+{
+  return static_cast<uint16_t>((val >> 8) | (val << 8));
+}
+
+inline uint32_t nc_bswap(uint32_t val)
+{
+  return (val >> 24) | ((val >> 8) & 0xff00) | ((val << 8) & 0xff0000) | (val << 24);
+}
+
+inline uint64_t nc_bswap(uint64_t val)
+{
+  return (static_cast<uint64_t>(nc_bswap(static_cast<uint32_t>(val))) << 32) | nc_bswap(static_cast<uint32_t>(val >> 32));
+}
+
+template <typename U>
+inline void nc_copy_bswap(void *dst, const void *src, size_t nbr)
+{
+  for (size_t idx = 0; idx < nbr; idx++)
+  {
+    U val;
+    memcpy(&val, static_cast<const char*>(src) + idx * sizeof(U), sizeof(U));
+    val = nc_bswap(val);
+    memcpy(static_cast<char*>(dst) + idx * sizeof(U), &val, sizeof(U));
+  }
+}
+
+inline void nc_copy_be(void *dst, const void *src, size_t nbr, size_t size)
+{
+  if (size == 1 || !nc_is_little_endian())
+  {
+    memcpy(dst, src, nbr * size);
+  }
+  else if (size == 2)
+  {
+    nc_copy_bswap<uint16_t>(dst, src, nbr);
+  }
+  else if (size == 4)
+  {
+    nc_copy_bswap<uint32_t>(dst, src, nbr);
+  }
+  else if (size == 8)
+  {
+    nc_copy_bswap<uint64_t>(dst, src, nbr);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_parallel_for
+//split the range [0, nbr) in one contiguous part per core, each a multiple of align elements (except
+//the last), and call func(idx_part, start, end) for each part on its own thread; all parts are done
+//on return, and part idx_part is always below nc_parallel_threads(), so that results of the parts can
+//be kept in a vector of that size and merged in order; if parallel is false, or there is one core,
+//func(0, 0, nbr) is called in the calling thread
+//std::thread is used since the batch mode runs without wxWidgets initialized
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline size_t nc_parallel_threads()
+{
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+template <typename F>
+inline void nc_parallel_for(size_t nbr, size_t align, bool parallel, F func)
+{
+  size_t nbr_thread = nc_parallel_threads();
+  if (!parallel || nbr_thread < 2 || nbr == 0)
+  {
+    func(0, 0, nbr);
+    return;
+  }
+  size_t nbr_part = (nbr + nbr_thread - 1) / nbr_thread;
+  nbr_part = (nbr_part + align - 1) / align * align;
+  std::vector<std::thread> threads;
+  size_t idx_part = 0;
+  for (size_t start = 0; start < nbr; start += nbr_part, idx_part++)
+  {
+    threads.push_back(std::thread(func, idx_part, start, std::min(start + nbr_part, nbr)));
+  }
+  for (size_t idx_thr = 0; idx_thr < threads.size(); idx_thr++)
+  {
+    threads[idx_thr].join();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_get_vara_type
+//typed hyperslab read, overloaded on the buffer type
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, float *buf)
+{
+  return nc_get_vara_float(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, double *buf)
+{
+  return nc_get_vara_double(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, int *buf)
+{
+  return nc_get_vara_int(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, short *buf)
+{
+  return nc_get_vara_short(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, char *buf)
+{
+  return nc_get_vara_text(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, signed char *buf)
+{
+  return nc_get_vara_schar(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, unsigned char *buf)
+{
+  return nc_get_vara_uchar(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, unsigned short *buf)
+{
+  return nc_get_vara_ushort(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, unsigned int *buf)
+{
+  return nc_get_vara_uint(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, long long *buf)
+{
+  return nc_get_vara_longlong(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, unsigned long long *buf)
+{
+  return nc_get_vara_ulonglong(nc_id, var_id, start, count, buf);
+}
+inline int nc_get_vara_type(int nc_id, int var_id, const size_t *start, const size_t *count, char **buf)
+{
+  return nc_get_vara_string(nc_id, var_id, start, count, buf);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncread_t
+//visitor to read a hyperslab of any type
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncread_t
+{
+public:
+  ncread_t(int nc_id, int var_id, const size_t *start, const size_t *count) :
+    m_nc_id(nc_id),
+    m_var_id(var_id),
+    m_start(start),
+    m_count(count),
+    m_status(NC_NOERR)
+  {
+  }
+  template <typename T>
+  void operator()(T *buf)
+  {
+    m_status = nc_get_vara_type(m_nc_id, m_var_id, m_start, m_count, buf);
+  }
+  int m_nc_id;
+  int m_var_id;
+  const size_t *m_start;
+  const size_t *m_count;
+  int m_status;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncfree_t
+//visitor to free a buffer of nbr elements (nc_buf_alloc); strings, allocated by the library, are 
+//freed one by one 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncfree_t
+{
+public:
+  ncfree_t(size_t nbr) : m_nbr(nbr)
+  {
+  }
+  template <typename T>
+  void operator()(T *buf)
+  {
+    nc_buf_free(buf);
+  }
+  void operator()(char **buf)
+  {
+    if (buf == NULL)
+    {
+      return;
+    }
+    for (size_t idx = 0; idx < m_nbr; idx++)
+    {
+      free(buf[idx]);
+    }
+    nc_buf_free(buf);
+  }
+  size_t m_nbr;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncbuf_t
+//buffer of nbr elements of a netCDF type, aligned (nc_buf_alloc); move-only, the single owner frees 
+//it (NC_STRING elements included); ownership moves from the reader to the variable without a copy
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncbuf_t
+{
+public:
+  ncbuf_t() :
+    m_nc_type(NC_NAT),
+    m_nbr(0),
+    m_data(NULL)
+  {
+  }
+  //allocate; NC_STRING buffers are always zeroed, so that a partial read can be freed
+  ncbuf_t(nc_type nc_typ, size_t nbr, bool zero = false) :
+    m_nc_type(nc_typ),
+    m_nbr(nbr),
+    m_data(nc_buf_alloc(nbr * nc_type_size(nc_typ), zero || nc_typ == NC_STRING))
+  {
+  }
+  ncbuf_t(ncbuf_t &&buf) :
+    m_nc_type(buf.m_nc_type),
+    m_nbr(buf.m_nbr),
+    m_data(buf.m_data)
+  {
+    buf.m_data = NULL;
+    buf.m_nbr = 0;
+  }
+  ncbuf_t& operator=(ncbuf_t &&buf)
+  {
+    if (this != &buf)
+    {
+      reset();
+      m_nc_type = buf.m_nc_type;
+      m_nbr = buf.m_nbr;
+      m_data = buf.m_data;
+      buf.m_data = NULL;
+      buf.m_nbr = 0;
+    }
+    return *this;
+  }
+  ~ncbuf_t()
+  {
+    reset();
+  }
+  //free data
+  void reset()
+  {
+    ncfree_t visitor(m_nbr);
+    if (!nc_visit(m_nc_type, m_data, visitor))
+    {
+      nc_buf_free(m_data);
+    }
+    m_data = NULL;
+    m_nbr = 0;
+  }
+  //free the buffer but not its elements, that were moved to another buffer (NC_STRING pointers)
+  void reset_moved()
+  {
+    nc_buf_free(m_data);
+    m_data = NULL;
+    m_nbr = 0;
+  }
+  void* data()
+  {
+    return m_data;
+  }
+  const void* data() const
+  {
+    return m_data;
+  }
+  template <typename T>
+  T* data_as()
+  {
+    return static_cast<T*>(m_data);
+  }
+  //element idx, in bytes from the start
+  void* at(size_t idx)
+  {
+    return static_cast<char*>(m_data) + idx * nc_type_size(m_nc_type);
+  }
+  nc_type type() const
+  {
+    return m_nc_type;
+  }
+  //number of elements
+  size_t size() const
+  {
+    return m_nbr;
+  }
+  bool empty() const
+  {
+    return m_data == NULL;
+  }
+
+private:
+  ncbuf_t(const ncbuf_t&);
+  ncbuf_t& operator=(const ncbuf_t&);
+  nc_type m_nc_type;
+  size_t m_nbr;
+  void *m_data;
+};
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //ncdim_t
-//a netCDF dimension has a name and a size
+//a netCDF dimension has a name (interned, see nc_intern) and a size
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class ncdim_t
 {
 public:
   ncdim_t(const char* name, size_t size) :
-    m_name(name),
+    m_name(nc_intern(name)),
     m_size(size)
   {
   }
-  std::string m_name;
+  bool operator==(const ncdim_t &ncdim) const
+  {
+    return m_name == ncdim.m_name && m_size == ncdim.m_size;
+  }
+  const char *m_name;
   size_t m_size;
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncdims_t
+//dimensions of a variable, shared by the variables of a group that have the same dimensions
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef std::shared_ptr<const std::vector<ncdim_t> > ncdims_t;
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //ncvar_t
 //a netCDF variable has a name, a netCDF type, data buffer, and an array of dimensions
 //defined in iteration
-//data buffer is stored on per load variable from tree using netCDF API from item input
+//data buffer is stored on per load variable from tree using netCDF API from item input; m_data owns
+//it and m_buf points to its data (NULL if not loaded) for the readers of the variable
+//dimensions are a copy of ncdim, or shared with other variables (ncgrp_t::share)
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class ncvar_t
 {
 public:
   ncvar_t(const char* name, nc_type nc_typ, const std::vector<ncdim_t> &ncdim) :
-    m_name(name),
+    m_name(nc_intern(name)),
     m_nc_type(nc_typ),
-    m_ncdim(ncdim)
+    m_ncdims(std::make_shared<const std::vector<ncdim_t> >(ncdim)),
+    m_ncdim(*m_ncdims),
+    m_deflate(0),
+    m_shuffle(false)
+  {
+    m_buf = NULL;
+  }
+  ncvar_t(const char* name, nc_type nc_typ, const ncdims_t &ncdims) :
+    m_name(nc_intern(name)),
+    m_nc_type(nc_typ),
+    m_ncdims(ncdims),
+    m_ncdim(*m_ncdims),
+    m_deflate(0),
+    m_shuffle(false)
   {
     m_buf = NULL;
   }
   ~ncvar_t()
   {
-    switch (m_nc_type)
+    release();
+  }
+  //free data buffer
+  void release()
+  {
+    m_data.reset();
+    m_buf = NULL;
+  }
+  //take the buffer (of size() elements of m_nc_type)
+  void store(ncbuf_t &&buf)
+  {
+    m_data = std::move(buf);
+    m_buf = m_data.data();
+  }
+  //number of elements (product of dimension sizes, 1 for scalars)
+  size_t size() const
+  {
+    size_t buf_sz = 1;
+    for (size_t idx_dmn = 0; idx_dmn < m_ncdim.size(); idx_dmn++)
     {
-    case NC_STRING:
-      if (m_buf)
-      {
-        char **buf_string = NULL;
-        size_t idx_buf = 0;
-        buf_string = static_cast<char**> (m_buf);
-        if (m_ncdim.size())
-        {
-          for (size_t idx_dmn = 0; idx_dmn < m_ncdim.size(); idx_dmn++)
-          {
-            for (size_t idx_sz = 0; idx_sz < m_ncdim[idx_dmn].m_size; idx_sz++)
-            {
-              free(buf_string[idx_buf]);
-              idx_buf++;
-            }
-          }
-        }
-        else
-        {
-          free(*buf_string);
-        }
-        free(static_cast<char**>(buf_string));
-      }
-      break;
-    default:
-      free(m_buf);
+      buf_sz *= m_ncdim[idx_dmn].m_size;
     }
+    return buf_sz;
   }
-  void store(void *buf)
+  //size in bytes of one element
+  size_t type_size() const
   {
-    m_buf = buf;
+    return nc_type_size(m_nc_type);
   }
-  std::string m_name;
+  const char *m_name; // interned
   nc_type m_nc_type;
-  void *m_buf;
-  std::vector<ncdim_t> m_ncdim;
+  ncbuf_t m_data; // owner of the data buffer
+  void *m_buf; // data of m_data, NULL if not loaded
+  ncdims_t m_ncdims; // owner of the dimensions
+  const std::vector<ncdim_t> &m_ncdim; // dimensions, *m_ncdims
+  std::vector<size_t> m_chunk; // (netCDF-4) chunk sizes, empty if not chunked
+  int m_deflate; // (netCDF-4) deflate level, 0 if not compressed
+  bool m_shuffle; // (netCDF-4) shuffle filter
+  std::vector<unsigned char> m_fill; // _FillValue (attribute or default), bytes of one element, empty if none
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncgrp_t
+//metadata of one netCDF group found in iteration: full name, variables (no data buffers)
+//and names of sub-groups; variables are owned until they are taken by tree items;
+//dimensions visible in the group are read once into a table (m_ncdim), from which the dimensions of
+//its variables are taken; variables with the same dimensions share one list of them (share), so 
+//that most variables allocate none
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncgrp_t
+{
+public:
+  ncgrp_t()
+  {
+  }
+  ~ncgrp_t()
+  {
+    for (size_t idx_var = 0; idx_var < m_ncvar.size(); idx_var++)
+    {
+      delete m_ncvar[idx_var];
+    }
+  }
+  std::string m_grp_nm_fll; // full name of group
+  std::vector<int> m_dimid; // dimension IDs visible in group (including parents)
+  std::vector<ncdim_t> m_ncdim; // dimensions of m_dimid
+  std::vector<ncvar_t *> m_ncvar; // variables
+  std::vector<std::string> m_grp_nm; // sub-group names
+  std::vector<bool> m_grp_empty; // sub-group has no variables and no sub-groups
+
+  //dimensions equal to ncdim, shared with the variables of the group found before with them
+  ncdims_t share(const std::vector<ncdim_t> &ncdim)
+  {
+    size_t hash = ncdim.size();
+    for (size_t idx_dmn = 0; idx_dmn < ncdim.size(); idx_dmn++)
+    {
+      hash = hash * 1000003 ^ reinterpret_cast<uintptr_t>(ncdim[idx_dmn].m_name) ^ ncdim[idx_dmn].m_size;
+    }
+    typedef std::unordered_multimap<size_t, ncdims_t>::const_iterator iterator_t;
+    std::pair<iterator_t, iterator_t> range = m_ncdims_var.equal_range(hash);
+    for (iterator_t it = range.first; it != range.second; ++it)
+    {
+      if (*it->second == ncdim)
+      {
+        return it->second;
+      }
+    }
+    ncdims_t ncdims = std::make_shared<const std::vector<ncdim_t> >(ncdim);
+    m_ncdims_var.insert(std::make_pair(hash, ncdims));
+    return ncdims;
+  }
+
+private:
+  std::unordered_multimap<size_t, ncdims_t> m_ncdims_var; // dimensions of variables, by hash
+  ncgrp_t(const ncgrp_t&);
+  ncgrp_t& operator=(const ncgrp_t&);
 };
 
 
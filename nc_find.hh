@@ -0,0 +1,181 @@
+#ifndef NC_FIND_HH
+#define NC_FIND_HH
+
+#include <vector>
+#include <algorithm>
+#include <netcdf.h>
+#include "nc_data.hh"
+#include "nc_pack.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncfind_t
+//condition of a value search: equal to m_val, in [m_val, m_val_max], greater or less than m_val, or
+//NaN; _FillValue never matches
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum
+{
+  nc_find_equal,
+  nc_find_range,
+  nc_find_greater,
+  nc_find_less,
+  nc_find_nan,
+  nc_find_nbr
+};
+
+class ncfind_t
+{
+public:
+  ncfind_t(int op = nc_find_equal, double val = 0, double val_max = 0) :
+    m_op(op),
+    m_val(val),
+    m_val_max(val_max)
+  {
+  }
+  int m_op; // nc_find_equal ... nc_find_nan
+  double m_val; // value, or minimum of range
+  double m_val_max; // maximum of range
+};
+
+const size_t max_find_hits = 1024 * 1024; //indices kept by a search
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncfinder_t
+//visitor that appends to hits (up to max_hits) offset + idx for the elements idx in [start, end) of a
+//buffer that match a condition; the condition of a block of elements is computed without branches
+//and the block is only scanned for indices when one of its elements matches (gcc does not vectorize
+//the condition at -O2, its comparisons in double need 64-bit masks)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_find_block = 256; //elements tested before looking for matches
+
+class ncfinder_t
+{
+public:
+  ncfinder_t(const ncfind_t &find, const std::vector<unsigned char> &fill, size_t start, size_t end, size_t offset,
+    size_t max_hits, std::vector<size_t> &hits) :
+    m_find(find),
+    m_fill(fill),
+    m_start(start),
+    m_end(end),
+    m_offset(offset),
+    m_max_hits(max_hits),
+    m_hits(hits)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    const bool is_equal = (m_find.m_op == nc_find_equal);
+    const bool is_range = (m_find.m_op == nc_find_range);
+    const bool is_greater = (m_find.m_op == nc_find_greater);
+    const bool is_less = (m_find.m_op == nc_find_less);
+    const bool is_nan = (m_find.m_op == nc_find_nan);
+    const double val_min = m_find.m_val;
+    const double val_max = m_find.m_val_max;
+    const bool has_fill = (m_fill.size() == sizeof(T));
+    const T fill = has_fill ? *reinterpret_cast<const T*>(&m_fill[0]) : T();
+    unsigned char match[nc_find_block];
+    for (size_t idx_blk = m_start; idx_blk < m_end && m_hits.size() < m_max_hits; idx_blk += nc_find_block)
+    {
+      size_t nbr = std::min(nc_find_block, m_end - idx_blk);
+      const T *in = buf + idx_blk;
+      unsigned char any = 0;
+      for (size_t idx = 0; idx < nbr; idx++)
+      {
+        double val = static_cast<double>(in[idx]);
+        bool is_match = (is_equal & (val == val_min)) | (is_range & (val >= val_min) & (val <= val_max)) |
+          (is_greater & (val > val_min)) | (is_less & (val < val_min)) | (is_nan & (val != val));
+        is_match = is_match & !(has_fill & (in[idx] == fill));
+        match[idx] = is_match;
+        any |= match[idx];
+      }
+      if (!any)
+      {
+        continue;
+      }
+      for (size_t idx = 0; idx < nbr && m_hits.size() < m_max_hits; idx++)
+      {
+        if (match[idx])
+        {
+          m_hits.push_back(m_offset + idx_blk + idx);
+        }
+      }
+    }
+  }
+  void operator()(const char *)
+  {
+  }
+  void operator()(char* const *)
+  {
+  }
+  const ncfind_t &m_find;
+  const std::vector<unsigned char> &m_fill;
+  size_t m_start;
+  size_t m_end;
+  size_t m_offset; // index of element 0 of the buffer
+  size_t m_max_hits;
+  std::vector<size_t> &m_hits;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_find_parallel
+//append to hits (up to max_hits, in order) offset + idx for the elements idx of a buffer of nbr
+//elements that match find; ranges of elements are searched on all cores
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t min_find_parallel = 256 * 1024; //elements
+
+inline void nc_find_parallel(nc_type nc_typ, const void *buf, size_t nbr, const std::vector<unsigned char> &fill,
+  const ncfind_t &find, size_t offset, size_t max_hits, std::vector<size_t> &hits)
+{
+  if (hits.size() >= max_hits)
+  {
+    return;
+  }
+  if (nbr < min_find_parallel || nc_parallel_threads() < 2)
+  {
+    ncfinder_t finder(find, fill, 0, nbr, offset, max_hits, hits);
+    nc_visit(nc_typ, buf, finder);
+    return;
+  }
+  size_t max_part = max_hits - hits.size();
+  std::vector<std::vector<size_t> > parts(nc_parallel_threads());
+  nc_parallel_for(nbr, 1, true, [&](size_t idx_part, size_t start, size_t end)
+  {
+    ncfinder_t finder(find, fill, start, end, offset, max_part, parts[idx_part]);
+    nc_visit(nc_typ, buf, finder);
+  });
+  for (size_t idx_prt = 0; idx_prt < parts.size() && hits.size() < max_hits; idx_prt++)
+  {
+    size_t nbr_hit = std::min(parts[idx_prt].size(), max_hits - hits.size());
+    hits.insert(hits.end(), parts[idx_prt].begin(), parts[idx_prt].begin() + nbr_hit);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_find_unpack
+//nc_find_parallel on the values of a packed variable, unpacked block by block (see nc_stats_unpack);
+//fill is _FillValue of the stored values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline void nc_find_unpack(nc_type nc_typ, const void *buf, size_t nbr, const std::vector<unsigned char> &fill,
+  const ncpack_t &pack, const ncfind_t &find, size_t offset, size_t max_hits, std::vector<size_t> &hits)
+{
+  if (!pack.is_unpacked())
+  {
+    nc_find_parallel(nc_typ, buf, nbr, fill, find, offset, max_hits, hits);
+    return;
+  }
+  size_t type_size = nc_type_size(nc_typ);
+  std::vector<unsigned char> fill_unpack = pack.fill();
+  std::vector<char> block(std::min(nbr, unpack_block_size) * nc_type_size(pack.m_nc_type));
+  for (size_t idx = 0; idx < nbr && hits.size() < max_hits; idx += unpack_block_size)
+  {
+    size_t nbr_block = std::min(unpack_block_size, nbr - idx);
+    nc_unpack_parallel(nc_typ, static_cast<const char*>(buf) + idx * type_size, nbr_block, pack, &block[0]);
+    nc_find_parallel(pack.m_nc_type, &block[0], nbr_block, fill_unpack, find, offset + idx, max_hits, hits);
+  }
+}
+
+#endif
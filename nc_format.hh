@@ -0,0 +1,264 @@
+#ifndef NC_FORMAT_HH
+#define NC_FORMAT_HH
+
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <stdio.h>
+#include <stdlib.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_format_uint, nc_format_int
+//decimal digits of an integer into out (at least nc_format_max characters), returns length
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_format_max = 32; //characters of a formatted number
+
+inline size_t nc_format_uint(unsigned long long val, char *out)
+{
+  char tmp[nc_format_max];
+  size_t len = 0;
+  do
+  {
+    tmp[len++] = static_cast<char>('0' + val % 10);
+    val /= 10;
+  } while (val);
+  for (size_t idx = 0; idx < len; idx++)
+  {
+    out[idx] = tmp[len - 1 - idx];
+  }
+  return len;
+}
+
+inline size_t nc_format_int(long long val, char *out)
+{
+  if (val < 0)
+  {
+    out[0] = '-';
+    return 1 + nc_format_uint(0ULL - static_cast<unsigned long long>(val), out + 1);
+  }
+  return nc_format_uint(static_cast<unsigned long long>(val), out);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_format_real
+//shortest representation that reads back to the same value; std::to_chars when available,
+//otherwise the lowest printf precision from prec_min that round trips
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+inline size_t nc_format_real(T val, char *out, int prec_min, int prec_max)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  (void)prec_min;
+  (void)prec_max;
+  return std::to_chars(out, out + nc_format_max, val).ptr - out;
+#else
+  for (int prec = prec_min;; prec++)
+  {
+    int len = snprintf(out, nc_format_max, "%.*g", prec, static_cast<double>(val));
+    if (prec >= prec_max || static_cast<T>(strtod(out, NULL)) == val)
+    {
+      return static_cast<size_t>(len);
+    }
+  }
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncformat_t
+//formatter of values of one netCDF type, chosen once (per variable or layer) instead of
+//a printf format parsed for each value; append() adds the text of element idx of a buffer
+//big_endian formats values as stored in classic format files (mapped by ncmmap_t)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncformat_t
+{
+public:
+  typedef void(*format_t)(const void *buf, size_t idx, std::string &out);
+  ncformat_t(nc_type nc_typ, bool big_endian = false)
+  {
+    select_t visitor(big_endian && nc_is_little_endian());
+    nc_visit(nc_typ, static_cast<const void*>(NULL), visitor);
+    m_format = visitor.m_format;
+  }
+  void append(const void *buf, size_t idx, std::string &out) const
+  {
+    m_format(buf, idx, out);
+  }
+
+protected:
+  format_t m_format;
+  //visitor that selects the format function of a type
+  class select_t
+  {
+  public:
+    select_t(bool swap) : m_format(format_none), m_swap(swap)
+    {
+    }
+    void operator()(const float *)
+    {
+      m_format = m_swap ? format_swap<float, format_float> : format_float;
+    }
+    void operator()(const double *)
+    {
+      m_format = m_swap ? format_swap<double, format_double> : format_double;
+    }
+    void operator()(const char *)
+    {
+      m_format = format_char;
+    }
+    void operator()(char* const *)
+    {
+      m_format = format_string;
+    }
+    template <typename T>
+    void operator()(const T *)
+    {
+      if (std::is_signed<T>::value)
+      {
+        m_format = m_swap ? format_swap<T, format_int<T> > : format_int<T>;
+      }
+      else
+      {
+        m_format = m_swap ? format_swap<T, format_uint<T> > : format_uint<T>;
+      }
+    }
+    format_t m_format;
+    bool m_swap; // values are in the other byte order
+  };
+  //element in the other byte order, swapped and formatted with F
+  template <typename T, format_t F>
+  static void format_swap(const void *buf, size_t idx, std::string &out)
+  {
+    T val;
+    nc_copy_be(&val, static_cast<const char*>(buf) + idx * sizeof(T), 1, sizeof(T));
+    F(&val, 0, out);
+  }
+  static void format_float(const void *buf, size_t idx, std::string &out)
+  {
+    char str[nc_format_max];
+    out.append(str, nc_format_real(static_cast<const float*>(buf)[idx], str, 6, 9));
+  }
+  static void format_double(const void *buf, size_t idx, std::string &out)
+  {
+    char str[nc_format_max];
+    out.append(str, nc_format_real(static_cast<const double*>(buf)[idx], str, 12, 17));
+  }
+  template <typename T>
+  static void format_int(const void *buf, size_t idx, std::string &out)
+  {
+    char str[nc_format_max];
+    out.append(str, nc_format_int(static_cast<const T*>(buf)[idx], str));
+  }
+  template <typename T>
+  static void format_uint(const void *buf, size_t idx, std::string &out)
+  {
+    char str[nc_format_max];
+    out.append(str, nc_format_uint(static_cast<const T*>(buf)[idx], str));
+  }
+  static void format_char(const void *buf, size_t idx, std::string &out)
+  {
+    out.push_back(static_cast<const char*>(buf)[idx]);
+  }
+  static void format_string(const void *buf, size_t idx, std::string &out)
+  {
+    const char *str = static_cast<char* const*>(buf)[idx];
+    if (str != NULL)
+    {
+      out.append(str);
+    }
+  }
+  static void format_none(const void *, size_t, std::string &)
+  {
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncarena_t
+//formatted values stored end to end in one buffer; clear() keeps the memory for the next layer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncarena_t
+{
+public:
+  void clear()
+  {
+    m_buf.clear();
+    m_end.clear();
+  }
+  size_t size() const
+  {
+    return m_end.size();
+  }
+  const char* str(size_t idx) const
+  {
+    return m_buf.data() + (idx ? m_end[idx - 1] : 0);
+  }
+  size_t length(size_t idx) const
+  {
+    return m_end[idx] - (idx ? m_end[idx - 1] : 0);
+  }
+  //format nbr elements of buf from idx_start
+  void format(const ncformat_t &fmt, const void *buf, size_t idx_start, size_t nbr)
+  {
+    m_end.reserve(m_end.size() + nbr);
+    for (size_t idx = idx_start; idx < idx_start + nbr; idx++)
+    {
+      fmt.append(buf, idx, m_buf);
+      m_end.push_back(m_buf.size());
+    }
+  }
+  //append values of another arena
+  void append(const ncarena_t &arena)
+  {
+    size_t offset = m_buf.size();
+    m_buf.append(arena.m_buf);
+    for (size_t idx = 0; idx < arena.m_end.size(); idx++)
+    {
+      m_end.push_back(offset + arena.m_end[idx]);
+    }
+  }
+protected:
+  std::string m_buf; // values
+  std::vector<size_t> m_end; // end of each value in m_buf
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_format_parallel
+//format nbr elements of buf from idx_start into arena, in parallel for large ranges; each thread
+//formats a contiguous part into its own arena of parts (kept by the caller for reuse) and the parts
+//are joined in order
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t min_format_parallel = 64 * 1024; //elements
+
+inline void nc_format_parallel(const ncformat_t &fmt, const void *buf, size_t idx_start, size_t nbr,
+  ncarena_t &arena, std::vector<ncarena_t> &parts)
+{
+  if (nbr < min_format_parallel || nc_parallel_threads() < 2)
+  {
+    arena.format(fmt, buf, idx_start, nbr);
+    return;
+  }
+  parts.resize(nc_parallel_threads());
+  for (size_t idx_part = 0; idx_part < parts.size(); idx_part++)
+  {
+    parts[idx_part].clear();
+  }
+  nc_parallel_for(nbr, 1, true, [&](size_t idx_part, size_t start, size_t end)
+  {
+    parts[idx_part].format(fmt, buf, idx_start + start, end - start);
+  });
+  for (size_t idx_part = 0; idx_part < parts.size(); idx_part++)
+  {
+    arena.append(parts[idx_part]);
+  }
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef NC_INTERN_HH
+#define NC_INTERN_HH
+
+#include <vector>
+#include <mutex>
+#include <unordered_set>
+#include <string.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncintern_t
+//table of interned names (variables, dimensions, groups, files): each distinct name is stored once,
+//in blocks of nc_intern_block bytes, and identified by its address for the life of the table, so
+//that metadata holds a pointer instead of a copy and equal names compare as equal pointers;
+//thread-safe (names are interned by the open workers and by the GUI thread)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_intern_block = 64 * 1024; //bytes
+
+class ncintern_t
+{
+public:
+  ncintern_t() :
+    m_used(nc_intern_block),
+    m_size(0)
+  {
+  }
+  ~ncintern_t()
+  {
+    for (size_t idx_blk = 0; idx_blk < m_block.size(); idx_blk++)
+    {
+      delete[] m_block[idx_blk];
+    }
+  }
+  //interned copy of a name
+  const char* intern(const char *str)
+  {
+    size_t len = strlen(str);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_set<key_t, hash_t>::const_iterator it = m_names.find(key_t(str, len));
+    if (it != m_names.end())
+    {
+      return it->m_str;
+    }
+    char *name;
+    if (len + 1 > nc_intern_block)
+    {
+      name = new char[len + 1];
+      m_block.push_back(name);
+      m_size += len + 1;
+    }
+    else
+    {
+      if (m_used + len + 1 > nc_intern_block)
+      {
+        m_block.push_back(new char[nc_intern_block]);
+        m_used = 0;
+        m_size += nc_intern_block;
+      }
+      name = m_block.back() + m_used;
+      m_used += len + 1;
+    }
+    memcpy(name, str, len + 1);
+    m_names.insert(key_t(name, len));
+    return name;
+  }
+  //number of names
+  size_t size()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_names.size();
+  }
+  //bytes of blocks and of the hash table (approximate)
+  size_t memory()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size + m_names.size() * (sizeof(key_t) + 2 * sizeof(void*)) + m_names.bucket_count() * sizeof(void*);
+  }
+
+protected:
+  class key_t
+  {
+  public:
+    key_t(const char *str, size_t len) : m_str(str), m_len(len)
+    {
+    }
+    bool operator==(const key_t &key) const
+    {
+      return m_len == key.m_len && memcmp(m_str, key.m_str, m_len) == 0;
+    }
+    const char *m_str;
+    size_t m_len;
+  };
+  //FNV-1a
+  class hash_t
+  {
+  public:
+    size_t operator()(const key_t &key) const
+    {
+      size_t hash = 14695981039346656037ULL;
+      for (size_t idx = 0; idx < key.m_len; idx++)
+      {
+        hash = (hash ^ static_cast<unsigned char>(key.m_str[idx])) * 1099511628211ULL;
+      }
+      return hash;
+    }
+  };
+  std::mutex m_mutex;
+  std::unordered_set<key_t, hash_t> m_names;
+  std::vector<char*> m_block; // storage of names
+  size_t m_used; // bytes used in last block
+  size_t m_size; // bytes of blocks
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_intern
+//interned copy of a name, in the table of the process (names are kept until exit)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline ncintern_t& nc_intern_table()
+{
+  static ncintern_t table;
+  return table;
+}
+
+inline const char* nc_intern(const char *str)
+{
+  return nc_intern_table().intern(str);
+}
+
+#endif
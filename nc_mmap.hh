@@ -0,0 +1,428 @@
+#ifndef NC_MMAP_HH
+#define NC_MMAP_HH
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncmmap_var_t
+//location of a variable in a classic format file; record variables have one slab of m_rec_elm
+//elements per record, records are m_recsize bytes apart
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncmmap_var_t
+{
+public:
+  ncmmap_var_t() :
+    m_nc_type(NC_NAT),
+    m_record(false),
+    m_begin(0),
+    m_rec_elm(1)
+  {
+  }
+  nc_type m_nc_type;
+  std::vector<size_t> m_shape; // dimension sizes, number of records for the record dimension
+  bool m_record; // first dimension is the record dimension
+  unsigned long long m_begin; // offset of data (of first record)
+  size_t m_rec_elm; // elements per record (all elements if not a record variable)
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncmmap_t
+//classic format file (CDF-1, CDF-2, CDF-5) mapped read-only in memory; the header is parsed for the
+//offsets of variables, whose elements are then addressed in the mapping (big-endian, as stored);
+//read() copies a hyperslab to a buffer in native order, so that only what is used is byte-swapped
+//the mapping is not modified after open(), so that it is used from any thread without a lock
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncmmap_t
+{
+public:
+  ncmmap_t() :
+    m_data(NULL),
+    m_size(0),
+    m_version(0),
+    m_numrecs(0),
+    m_recsize(0)
+  {
+  }
+  ~ncmmap_t()
+  {
+    close();
+  }
+  //map a file and parse its header, NC_ENOTNC if not a classic format file
+  int open(const char *file_name)
+  {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      return NC_EIO;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+      mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+      return NC_EIO;
+    }
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (m_data == NULL)
+    {
+      return NC_EIO;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(file_name, O_RDONLY);
+    if (fd < 0)
+    {
+      return NC_EIO;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      data = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+      return NC_EIO;
+    }
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<size_t>(st.st_size);
+#endif
+    if (!parse())
+    {
+      close();
+      return NC_ENOTNC;
+    }
+    return NC_NOERR;
+  }
+  void close()
+  {
+    if (m_data != NULL)
+    {
+#ifdef _WIN32
+      UnmapViewOfFile(m_data);
+#else
+      munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    }
+    m_data = NULL;
+    m_size = 0;
+    m_var.clear();
+  }
+  //variable that can be addressed in the mapping, NULL if none
+  const ncmmap_var_t* find(const std::string &name) const
+  {
+    std::map<std::string, ncmmap_var_t>::const_iterator it = m_var.find(name);
+    return (it != m_var.end()) ? &it->second : NULL;
+  }
+  //element idx of a variable (index in the variable as if it were contiguous), big-endian
+  const unsigned char* at(const ncmmap_var_t &var, size_t idx) const
+  {
+    size_t type_size = nc_type_size(var.m_nc_type);
+    if (!var.m_record)
+    {
+      return m_data + var.m_begin + idx * type_size;
+    }
+    return m_data + var.m_begin + (idx / var.m_rec_elm) * m_recsize + (idx % var.m_rec_elm) * type_size;
+  }
+  //copy a hyperslab of a variable to buf in native order; each run along the last dimension is
+  //contiguous in the file (except for variables of the record dimension only)
+  int read(const ncmmap_var_t &var, const size_t *start, const size_t *count, void *buf) const
+  {
+    size_t nbr_dmn = var.m_shape.size();
+    size_t type_size = nc_type_size(var.m_nc_type);
+    for (size_t idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
+    {
+      if (start[idx_dmn] + count[idx_dmn] > var.m_shape[idx_dmn])
+      {
+        return NC_EINVALCOORDS;
+      }
+      if (count[idx_dmn] == 0)
+      {
+        return NC_NOERR;
+      }
+    }
+    if (nbr_dmn == 0)
+    {
+      nc_copy_be(buf, at(var, 0), 1, type_size);
+      return NC_NOERR;
+    }
+    //one element per record
+    if (nbr_dmn == 1 && var.m_record)
+    {
+      for (size_t idx_rec = 0; idx_rec < count[0]; idx_rec++)
+      {
+        nc_copy_be(static_cast<char*>(buf) + idx_rec * type_size, at(var, start[0] + idx_rec), 1, type_size);
+      }
+      return NC_NOERR;
+    }
+    //stride of each dimension, in elements
+    std::vector<size_t> stride(nbr_dmn, 1);
+    for (size_t idx_dmn = nbr_dmn - 1; idx_dmn > 0; idx_dmn--)
+    {
+      stride[idx_dmn - 1] = stride[idx_dmn] * var.m_shape[idx_dmn];
+    }
+    size_t nbr_run = count[nbr_dmn - 1];
+    std::vector<size_t> idx(nbr_dmn, 0); // index in hyperslab, last dimension unused
+    char *out = static_cast<char*>(buf);
+    for (;;)
+    {
+      size_t idx_var = start[nbr_dmn - 1];
+      for (size_t idx_dmn = 0; idx_dmn + 1 < nbr_dmn; idx_dmn++)
+      {
+        idx_var += (start[idx_dmn] + idx[idx_dmn]) * stride[idx_dmn];
+      }
+      nc_copy_be(out, at(var, idx_var), nbr_run, type_size);
+      out += nbr_run * type_size;
+      size_t idx_dmn = nbr_dmn - 1;
+      while (idx_dmn > 0 && ++idx[idx_dmn - 1] == count[idx_dmn - 1])
+      {
+        idx[idx_dmn - 1] = 0;
+        idx_dmn--;
+      }
+      if (idx_dmn == 0)
+      {
+        return NC_NOERR;
+      }
+    }
+  }
+  const unsigned char *m_data; // mapped file
+  size_t m_size; // bytes
+  int m_version; // 1 (CDF-1), 2 (CDF-2, 64-bit offset), 5 (CDF-5, 64-bit data)
+  size_t m_numrecs; // number of records
+  size_t m_recsize; // bytes of one record (all record variables)
+
+protected:
+  std::map<std::string, ncmmap_var_t> m_var; // variables inside the mapping, by name
+
+  //sequential reader of the header, big-endian; m_ok is false once past the end of the file
+  class header_t
+  {
+  public:
+    header_t(const unsigned char *data, size_t size, int version) :
+      m_data(data),
+      m_size(size),
+      m_pos(4),
+      m_version(version),
+      m_ok(true)
+    {
+    }
+    unsigned long long get(size_t nbr_byte)
+    {
+      unsigned long long val = 0;
+      if (m_pos + nbr_byte > m_size)
+      {
+        m_ok = false;
+        return 0;
+      }
+      for (size_t idx = 0; idx < nbr_byte; idx++)
+      {
+        val = (val << 8) | m_data[m_pos++];
+      }
+      return val;
+    }
+    //NON_NEG: number of elements, dimension length
+    unsigned long long get_nonneg()
+    {
+      return get(m_version == 5 ? 8 : 4);
+    }
+    //OFFSET: begin of variable
+    unsigned long long get_offset()
+    {
+      return get(m_version == 1 ? 4 : 8);
+    }
+    void skip(unsigned long long nbr_byte)
+    {
+      nbr_byte = (nbr_byte + 3) / 4 * 4;
+      if (nbr_byte > m_size - m_pos)
+      {
+        m_ok = false;
+        return;
+      }
+      m_pos += static_cast<size_t>(nbr_byte);
+    }
+    std::string get_name()
+    {
+      unsigned long long len = get_nonneg();
+      if (!m_ok || len > m_size - m_pos)
+      {
+        m_ok = false;
+        return std::string();
+      }
+      std::string name(reinterpret_cast<const char*>(m_data + m_pos), static_cast<size_t>(len));
+      skip(len);
+      return name;
+    }
+    //list tag and number of elements (ABSENT is a zero tag)
+    unsigned long long get_list(unsigned int tag)
+    {
+      unsigned int tag_list = static_cast<unsigned int>(get(4));
+      unsigned long long nbr = get_nonneg();
+      if (tag_list != tag && (tag_list != 0 || nbr != 0))
+      {
+        m_ok = false;
+      }
+      return nbr;
+    }
+    void skip_atts()
+    {
+      unsigned long long nbr_att = get_list(0x0C);
+      for (unsigned long long idx_att = 0; idx_att < nbr_att && m_ok; idx_att++)
+      {
+        get_name();
+        nc_type nc_typ = static_cast<nc_type>(get(4));
+        unsigned long long nbr = get_nonneg();
+        size_t type_size = nc_type_size(nc_typ);
+        if (type_size == 0 || nbr > m_size / type_size)
+        {
+          m_ok = false;
+          return;
+        }
+        skip(nbr * type_size);
+      }
+    }
+    const unsigned char *m_data;
+    size_t m_size;
+    size_t m_pos;
+    int m_version;
+    bool m_ok;
+  };
+
+  //header of the file; variables whose data is not inside the file are left out (read by the library)
+  bool parse()
+  {
+    if (m_size < 8 || m_data[0] != 'C' || m_data[1] != 'D' || m_data[2] != 'F' ||
+      (m_data[3] != 1 && m_data[3] != 2 && m_data[3] != 5))
+    {
+      return false;
+    }
+    m_version = m_data[3];
+    header_t header(m_data, m_size, m_version);
+    unsigned long long numrecs = header.get_nonneg();
+    bool streaming = (numrecs == (m_version == 5 ? 0xFFFFFFFFFFFFFFFFULL : 0xFFFFFFFFULL));
+
+    std::vector<unsigned long long> dim_size;
+    unsigned long long nbr_dim = header.get_list(0x0A);
+    for (unsigned long long idx_dim = 0; idx_dim < nbr_dim && header.m_ok; idx_dim++)
+    {
+      header.get_name();
+      dim_size.push_back(header.get_nonneg());
+    }
+    header.skip_atts();
+
+    std::vector<std::string> var_nm;
+    std::vector<ncmmap_var_t> var;
+    unsigned long long nbr_var = header.get_list(0x0B);
+    for (unsigned long long idx_var = 0; idx_var < nbr_var && header.m_ok; idx_var++)
+    {
+      ncmmap_var_t ncvar;
+      var_nm.push_back(header.get_name());
+      unsigned long long nbr_dmn = header.get_nonneg();
+      for (unsigned long long idx_dmn = 0; idx_dmn < nbr_dmn && header.m_ok; idx_dmn++)
+      {
+        unsigned long long dim_id = header.get_nonneg();
+        if (dim_id >= dim_size.size())
+        {
+          return false;
+        }
+        ncvar.m_shape.push_back(static_cast<size_t>(dim_size[dim_id]));
+        if (dim_size[dim_id] == 0)
+        {
+          ncvar.m_record = (idx_dmn == 0);
+        }
+      }
+      header.skip_atts();
+      ncvar.m_nc_type = static_cast<nc_type>(header.get(4));
+      header.get_nonneg(); //vsize, computed from the shape (it does not fit 32 bits for large variables)
+      ncvar.m_begin = header.get_offset();
+      var.push_back(ncvar);
+    }
+    if (!header.m_ok)
+    {
+      return false;
+    }
+
+    //records: size of each record variable padded to 4 bytes, unless there is only one
+    size_t nbr_rec_var = 0;
+    unsigned long long rec_begin = 0;
+    m_recsize = 0;
+    for (size_t idx_var = 0; idx_var < var.size(); idx_var++)
+    {
+      ncmmap_var_t &ncvar = var[idx_var];
+      for (size_t idx_dmn = ncvar.m_record ? 1 : 0; idx_dmn < ncvar.m_shape.size(); idx_dmn++)
+      {
+        ncvar.m_rec_elm *= ncvar.m_shape[idx_dmn];
+      }
+      if (ncvar.m_record)
+      {
+        rec_begin = nbr_rec_var ? std::min(rec_begin, ncvar.m_begin) : ncvar.m_begin;
+        m_recsize += (ncvar.m_rec_elm * nc_type_size(ncvar.m_nc_type) + 3) / 4 * 4;
+        nbr_rec_var++;
+      }
+    }
+    for (size_t idx_var = 0; idx_var < var.size() && nbr_rec_var == 1; idx_var++)
+    {
+      if (var[idx_var].m_record)
+      {
+        m_recsize = var[idx_var].m_rec_elm * nc_type_size(var[idx_var].m_nc_type);
+      }
+    }
+    if (streaming)
+    {
+      numrecs = (m_recsize > 0 && m_size > rec_begin) ? (m_size - rec_begin) / m_recsize : 0;
+    }
+    m_numrecs = static_cast<size_t>(numrecs);
+
+    //variables whose last element is inside the file
+    for (size_t idx_var = 0; idx_var < var.size(); idx_var++)
+    {
+      ncmmap_var_t &ncvar = var[idx_var];
+      size_t type_size = nc_type_size(ncvar.m_nc_type);
+      unsigned long long end = ncvar.m_begin;
+      if (ncvar.m_record)
+      {
+        ncvar.m_shape[0] = m_numrecs;
+        end += m_numrecs ? (m_numrecs - 1) * static_cast<unsigned long long>(m_recsize) + ncvar.m_rec_elm * type_size : 0;
+      }
+      else
+      {
+        end += ncvar.m_rec_elm * static_cast<unsigned long long>(type_size);
+      }
+      if (type_size > 0 && ncvar.m_nc_type != NC_STRING && end <= m_size)
+      {
+        m_var[var_nm[idx_var]] = ncvar;
+      }
+    }
+    return true;
+  }
+
+private:
+  ncmmap_t(const ncmmap_t&);
+  ncmmap_t& operator=(const ncmmap_t&);
+};
+
+#endif
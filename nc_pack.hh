@@ -0,0 +1,316 @@
+#ifndef NC_PACK_HH
+#define NC_PACK_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <string.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+#include "nc_stats.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncpack_t
+//CF packing and missing values of a variable (scale_factor, add_offset, _FillValue, missing_value,
+//valid_range, valid_min, valid_max), in packed units; values are unpacked to m_nc_type (the type of
+//scale_factor, or a floating point type wide enough for the variable when only missing values are
+//defined) as value * scale_factor + add_offset; _FillValue is unpacked to the default fill value of
+//that type, other missing values to NaN
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t max_pack_missing = 2; //values of missing_value
+
+class ncpack_t
+{
+public:
+  ncpack_t() :
+    m_nc_type(NC_NAT),
+    m_scale(1),
+    m_offset(0),
+    m_has_fill(false),
+    m_fill(0),
+    m_nbr_missing(0),
+    m_valid_min(-std::numeric_limits<double>::infinity()),
+    m_valid_max(std::numeric_limits<double>::infinity())
+  {
+    m_missing[0] = m_missing[1] = 0;
+  }
+  //values are unpacked (or masked) before being shown
+  bool is_unpacked() const
+  {
+    return m_nc_type != NC_NAT;
+  }
+  //bytes of the fill value of unpacked values, empty if none
+  std::vector<unsigned char> fill() const
+  {
+    std::vector<unsigned char> bytes;
+    if (m_has_fill && m_nc_type == NC_FLOAT)
+    {
+      float fill = NC_FILL_FLOAT;
+      bytes.assign(reinterpret_cast<unsigned char*>(&fill), reinterpret_cast<unsigned char*>(&fill) + sizeof(fill));
+    }
+    else if (m_has_fill && m_nc_type == NC_DOUBLE)
+    {
+      double fill = NC_FILL_DOUBLE;
+      bytes.assign(reinterpret_cast<unsigned char*>(&fill), reinterpret_cast<unsigned char*>(&fill) + sizeof(fill));
+    }
+    return bytes;
+  }
+  nc_type m_nc_type; // type of unpacked values (NC_FLOAT, NC_DOUBLE), NC_NAT if values are shown as stored
+  double m_scale; // scale_factor
+  double m_offset; // add_offset
+  bool m_has_fill;
+  double m_fill; // _FillValue
+  size_t m_nbr_missing;
+  double m_missing[max_pack_missing]; // missing_value
+  double m_valid_min; // valid_range, valid_min
+  double m_valid_max; // valid_range, valid_max
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_inq_pack
+//read the packing attributes of a variable; fill holds the bytes of its _FillValue (empty if none)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncdouble_t
+{
+public:
+  ncdouble_t() : m_val(0)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    m_val = static_cast<double>(buf[0]);
+  }
+  void operator()(char* const *)
+  {
+  }
+  double m_val;
+};
+
+inline int nc_inq_pack(int grp_id, int var_id, nc_type var_type, const std::vector<unsigned char> &fill, ncpack_t &pack)
+{
+  nc_type att_type;
+  size_t att_len;
+  double val[2];
+  bool is_packed = false;
+  bool is_masked = false;
+  pack = ncpack_t();
+  if (var_type == NC_CHAR || var_type == NC_STRING || nc_type_size(var_type) == 0)
+  {
+    return NC_NOERR;
+  }
+  nc_type unpack_type = NC_FLOAT;
+  if (nc_inq_att(grp_id, var_id, "scale_factor", &att_type, &att_len) == NC_NOERR && att_len == 1 &&
+    nc_get_att_double(grp_id, var_id, "scale_factor", &pack.m_scale) == NC_NOERR)
+  {
+    is_packed = true;
+    unpack_type = att_type;
+  }
+  if (nc_inq_att(grp_id, var_id, "add_offset", &att_type, &att_len) == NC_NOERR && att_len == 1 &&
+    nc_get_att_double(grp_id, var_id, "add_offset", &pack.m_offset) == NC_NOERR)
+  {
+    is_packed = true;
+    unpack_type = (att_type == NC_DOUBLE) ? NC_DOUBLE : unpack_type;
+  }
+  if (nc_inq_att(grp_id, var_id, "missing_value", &att_type, &att_len) == NC_NOERR && att_len >= 1 && att_len <= max_pack_missing &&
+    nc_get_att_double(grp_id, var_id, "missing_value", val) == NC_NOERR)
+  {
+    is_masked = true;
+    pack.m_nbr_missing = att_len;
+    pack.m_missing[0] = val[0];
+    pack.m_missing[1] = val[att_len - 1];
+  }
+  if (nc_inq_att(grp_id, var_id, "valid_range", &att_type, &att_len) == NC_NOERR && att_len == 2 &&
+    nc_get_att_double(grp_id, var_id, "valid_range", val) == NC_NOERR)
+  {
+    is_masked = true;
+    pack.m_valid_min = val[0];
+    pack.m_valid_max = val[1];
+  }
+  if (nc_inq_att(grp_id, var_id, "valid_min", &att_type, &att_len) == NC_NOERR && att_len == 1 &&
+    nc_get_att_double(grp_id, var_id, "valid_min", val) == NC_NOERR)
+  {
+    is_masked = true;
+    pack.m_valid_min = val[0];
+  }
+  if (nc_inq_att(grp_id, var_id, "valid_max", &att_type, &att_len) == NC_NOERR && att_len == 1 &&
+    nc_get_att_double(grp_id, var_id, "valid_max", val) == NC_NOERR)
+  {
+    is_masked = true;
+    pack.m_valid_max = val[0];
+  }
+  if (fill.size() == nc_type_size(var_type))
+  {
+    ncdouble_t visitor;
+    nc_visit(var_type, static_cast<const void*>(&fill[0]), visitor);
+    pack.m_has_fill = true;
+    pack.m_fill = visitor.m_val;
+  }
+  //only masked: floating point wide enough for the values stored
+  if (is_packed)
+  {
+    pack.m_nc_type = (unpack_type == NC_DOUBLE) ? NC_DOUBLE : NC_FLOAT;
+  }
+  else if (is_masked)
+  {
+    pack.m_nc_type = (var_type == NC_FLOAT || nc_type_size(var_type) < 4) ? NC_FLOAT : NC_DOUBLE;
+  }
+  return NC_NOERR;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncunpack_t
+//visitor that unpacks elements [start, end) of a buffer to out (unpacked type U, out[0] for element
+//start); elements are unpacked in blocks of nc_unpack_lanes into a local array, and the masks only
+//select values (NaN, or 0 and the fill value as operands of the unpack), never a result computed in
+//one branch, so that gcc vectorizes the block at -O2 (not for 64-bit integers, that SSE2 cannot
+//convert)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_unpack_lanes = 16;
+
+template <typename U>
+class ncunpack_t
+{
+public:
+  ncunpack_t(const ncpack_t &pack, size_t start, size_t end, U *out) :
+    m_pack(pack),
+    m_start(start),
+    m_end(end),
+    m_out(out)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    const double scale = m_pack.m_scale;
+    const double offset = m_pack.m_offset;
+    const bool has_fill = m_pack.m_has_fill;
+    const double fill = m_pack.m_fill;
+    const bool has_missing0 = (m_pack.m_nbr_missing > 0);
+    const bool has_missing1 = (m_pack.m_nbr_missing > 1);
+    const double missing0 = m_pack.m_missing[0];
+    const double missing1 = m_pack.m_missing[1];
+    const double valid_min = m_pack.m_valid_min;
+    const double valid_max = m_pack.m_valid_max;
+    const double fill_out = (sizeof(U) == sizeof(float)) ? NC_FILL_FLOAT : NC_FILL_DOUBLE;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    //_FillValue unpacked as 0 * scale + fill_out, missing values as NaN * scale + offset
+    auto unpack = [&](double val) -> U
+    {
+      bool is_fill = has_fill & (val == fill);
+      bool is_missing = !(val >= valid_min) | !(val <= valid_max) | (has_missing0 & (val == missing0)) | (has_missing1 & (val == missing1));
+      val = is_missing ? nan : val;
+      val = is_fill ? 0.0 : val;
+      double add = is_fill ? fill_out : offset;
+      return static_cast<U>(val * scale + add);
+    };
+    const T *in = buf + m_start;
+    size_t nbr = m_end - m_start;
+    size_t nbr_lanes = nbr / nc_unpack_lanes * nc_unpack_lanes;
+    for (size_t idx = 0; idx < nbr_lanes; idx += nc_unpack_lanes)
+    {
+      U out[nc_unpack_lanes];
+      for (size_t lane = 0; lane < nc_unpack_lanes; lane++)
+      {
+        out[lane] = unpack(static_cast<double>(in[idx + lane]));
+      }
+      memcpy(m_out + idx, out, sizeof(out));
+    }
+    for (size_t idx = nbr_lanes; idx < nbr; idx++)
+    {
+      m_out[idx] = unpack(static_cast<double>(in[idx]));
+    }
+  }
+  void operator()(const char *)
+  {
+  }
+  void operator()(char* const *)
+  {
+  }
+  const ncpack_t &m_pack;
+  size_t m_start;
+  size_t m_end;
+  U *m_out;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_unpack_parallel
+//unpack nbr elements of buf to out (nbr elements of pack.m_nc_type), split across cores
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t min_unpack_parallel = 256 * 1024; //elements
+
+template <typename U>
+inline void nc_unpack_type(nc_type nc_typ, const void *buf, size_t nbr, const ncpack_t &pack, U *out)
+{
+  nc_parallel_for(nbr, 1, nbr >= min_unpack_parallel, [&](size_t, size_t start, size_t end)
+  {
+    ncunpack_t<U> unpack(pack, start, end, out + start);
+    nc_visit(nc_typ, buf, unpack);
+  });
+}
+
+inline void nc_unpack_parallel(nc_type nc_typ, const void *buf, size_t nbr, const ncpack_t &pack, void *out)
+{
+  if (pack.m_nc_type == NC_DOUBLE)
+  {
+    nc_unpack_type(nc_typ, buf, nbr, pack, static_cast<double*>(out));
+  }
+  else
+  {
+    nc_unpack_type(nc_typ, buf, nbr, pack, static_cast<float*>(out));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_unpack_at
+//unpack element idx of buf to out (one element of pack.m_nc_type); false if it is _FillValue or a
+//missing value
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline bool nc_unpack_at(nc_type nc_typ, const void *buf, size_t idx, const ncpack_t &pack, void *out)
+{
+  if (pack.m_nc_type == NC_DOUBLE)
+  {
+    double *val = static_cast<double*>(out);
+    ncunpack_t<double> unpack(pack, idx, idx + 1, val);
+    nc_visit(nc_typ, buf, unpack);
+    return *val == *val && *val != NC_FILL_DOUBLE;
+  }
+  float *val = static_cast<float*>(out);
+  ncunpack_t<float> unpack(pack, idx, idx + 1, val);
+  nc_visit(nc_typ, buf, unpack);
+  return *val == *val && *val != NC_FILL_FLOAT;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_stats_unpack
+//add the statistics of nbr elements of buf to stats, unpacked block by block when the variable is
+//packed (no unpacked copy of the whole buffer); fill is _FillValue of the stored values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t unpack_block_size = 1024 * 1024; //elements
+
+inline void nc_stats_unpack(nc_type nc_typ, const void *buf, size_t nbr, const std::vector<unsigned char> &fill,
+  const ncpack_t &pack, ncstats_t &stats)
+{
+  if (!pack.is_unpacked())
+  {
+    nc_stats_parallel(nc_typ, buf, nbr, fill, stats);
+    return;
+  }
+  size_t type_size = nc_type_size(nc_typ);
+  std::vector<unsigned char> fill_unpack = pack.fill();
+  std::vector<char> block(std::min(nbr, unpack_block_size) * nc_type_size(pack.m_nc_type));
+  for (size_t idx = 0; idx < nbr; idx += unpack_block_size)
+  {
+    size_t nbr_block = std::min(unpack_block_size, nbr - idx);
+    nc_unpack_parallel(nc_typ, static_cast<const char*>(buf) + idx * type_size, nbr_block, pack, &block[0]);
+    nc_stats_parallel(pack.m_nc_type, &block[0], nbr_block, fill_unpack, stats);
+  }
+}
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef NC_POOL_HH
+#define NC_POOL_HH
+
+#include <string>
+#include <list>
+#include <map>
+#include <time.h>
+#include <netcdf.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncpool_t
+//pool of open netCDF files, keyed by file name (or OPeNDAP URL), with resolved group IDs
+//at most m_max_open files are kept open (least recently used is closed first), and files 
+//not used for m_max_idle seconds are closed by expire()
+//IDs returned are valid until the next call to the pool; files are not closed by the destructor, 
+//call close_all() before exit 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncpool_t
+{
+public:
+  ncpool_t(size_t max_open, time_t max_idle) :
+    m_max_open(max_open),
+    m_max_idle(max_idle)
+  {
+  }
+
+  //get ID of an open file
+  int open(const char *file_name, int *nc_id)
+  {
+    handle_t *handle;
+    int status = find(file_name, &handle);
+    if (status == NC_NOERR)
+    {
+      *nc_id = handle->m_nc_id;
+    }
+    return status;
+  }
+
+  //get ID of an open file and of the group with full name in it 
+  int open_group(const char *file_name, const char *grp_nm_fll, int *nc_id, int *grp_id)
+  {
+    handle_t *handle;
+    int status = find(file_name, &handle);
+    if (status != NC_NOERR)
+    {
+      return status;
+    }
+    *nc_id = handle->m_nc_id;
+
+    //nc_inq_grp_full_ncid does not handle netCDF3 cases, the group ID is the file ID
+    if (handle->m_fl_fmt != NC_FORMAT_NETCDF4 && handle->m_fl_fmt != NC_FORMAT_NETCDF4_CLASSIC)
+    {
+      *grp_id = handle->m_nc_id;
+      return NC_NOERR;
+    }
+
+    std::map<std::string, int>::iterator it = handle->m_grp_id.find(grp_nm_fll);
+    if (it != handle->m_grp_id.end())
+    {
+      *grp_id = it->second;
+      return NC_NOERR;
+    }
+    if ((status = nc_inq_grp_full_ncid(handle->m_nc_id, grp_nm_fll, grp_id)) != NC_NOERR)
+    {
+      return status;
+    }
+    handle->m_grp_id[grp_nm_fll] = *grp_id;
+    return NC_NOERR;
+  }
+
+  //close files idle for more than m_max_idle seconds
+  void expire()
+  {
+    time_t now = time(NULL);
+    std::list<handle_t>::iterator it = m_handle.begin();
+    while (it != m_handle.end())
+    {
+      if (now - it->m_time > m_max_idle)
+      {
+        nc_close(it->m_nc_id);
+        it = m_handle.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  void close_all()
+  {
+    for (std::list<handle_t>::iterator it = m_handle.begin(); it != m_handle.end(); ++it)
+    {
+      nc_close(it->m_nc_id);
+    }
+    m_handle.clear();
+  }
+
+  size_t m_max_open; // maximum number of files kept open
+  time_t m_max_idle; // seconds a file is kept open without use
+
+protected:
+  class handle_t
+  {
+  public:
+    handle_t(const char *file_name, int nc_id, int fl_fmt) :
+      m_file_name(file_name),
+      m_nc_id(nc_id),
+      m_fl_fmt(fl_fmt),
+      m_time(time(NULL))
+    {
+    }
+    std::string m_file_name;
+    int m_nc_id;
+    int m_fl_fmt; // file format
+    time_t m_time; // last use
+    std::map<std::string, int> m_grp_id; // group full name, group ID 
+  };
+
+  //get handle for file name, opened if needed, and make it the most recently used
+  int find(const char *file_name, handle_t **handle)
+  {
+    int nc_id;
+    int fl_fmt;
+    int status;
+    for (std::list<handle_t>::iterator it = m_handle.begin(); it != m_handle.end(); ++it)
+    {
+      if (it->m_file_name == file_name)
+      {
+        m_handle.splice(m_handle.begin(), m_handle, it);
+        m_handle.front().m_time = time(NULL);
+        *handle = &m_handle.front();
+        return NC_NOERR;
+      }
+    }
+    if ((status = nc_open(file_name, NC_NOWRITE, &nc_id)) != NC_NOERR)
+    {
+      return status;
+    }
+    if ((status = nc_inq_format(nc_id, &fl_fmt)) != NC_NOERR)
+    {
+      nc_close(nc_id);
+      return status;
+    }
+    while (m_handle.size() && m_handle.size() >= m_max_open)
+    {
+      nc_close(m_handle.back().m_nc_id);
+      m_handle.pop_back();
+    }
+    m_handle.push_front(handle_t(file_name, nc_id, fl_fmt));
+    *handle = &m_handle.front();
+    return NC_NOERR;
+  }
+
+  std::list<handle_t> m_handle; // most recently used first
+};
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef NC_PYRAMID_HH
+#define NC_PYRAMID_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <string.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+#include "nc_stats.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nclevel_t
+//one downsampled level of a layer: min, max and mean of the valid values of each block (missing value
+//if none), in the type of the layer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int nc_level_min = 0;
+const int nc_level_max = 1;
+const int nc_level_mean = 2;
+
+class nclevel_t
+{
+public:
+  nclevel_t(size_t nbr_rows, size_t nbr_cols, size_t block, size_t type_size) :
+    m_nbr_rows(nbr_rows),
+    m_nbr_cols(nbr_cols),
+    m_block(block)
+  {
+    for (int idx = 0; idx < 3; idx++)
+    {
+      m_buf[idx].resize(nbr_rows * nbr_cols * type_size);
+    }
+  }
+  size_t m_nbr_rows;
+  size_t m_nbr_cols;
+  size_t m_block; // elements of the layer on each side of a block
+  std::vector<char> m_buf[3]; // min, max, mean
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncreduce_t
+//visitor that computes rows [row_start, row_end) of a level from the previous level (or from the
+//layer, given as min, max and mean); each block of the level reduces factor x factor blocks of the
+//input; missing values are skipped by selecting instead of branching
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_pyramid_base = 4; //elements on each side of a block of level 1
+const size_t min_reduce_parallel = 1024 * 1024; //elements of input
+const size_t nc_reduce_lanes = 16; //columns of input accumulated together
+
+//accumulate N columns of input (pointers to their first element) over rows [row_in_start, row_in_end)
+//in local arrays, and store them to acc; the fixed count of columns, the local arrays and the masks
+//(a select of a converted value is compiled as a branch) let gcc vectorize the column loop at -O2
+//for types up to 32 bits (not for double or 64-bit integers, their comparisons are not widened)
+template <typename T, size_t N>
+inline void nc_reduce_columns(const T *in_min, const T *in_max, const T *in_mean, size_t nbr_cols_in,
+  size_t row_in_start, size_t row_in_end, bool has_fill, T fill, T *acc_min, T *acc_max, double *acc_sum, double *acc_nbr)
+{
+  T lane_min[N];
+  T lane_max[N];
+  double lane_sum[N];
+  double lane_nbr[N];
+  for (size_t lane = 0; lane < N; lane++)
+  {
+    lane_min[lane] = std::numeric_limits<T>::max();
+    lane_max[lane] = std::numeric_limits<T>::lowest();
+    lane_sum[lane] = 0;
+    lane_nbr[lane] = 0;
+  }
+  for (size_t row_in = row_in_start; row_in < row_in_end; row_in++)
+  {
+    size_t idx_in = row_in * nbr_cols_in;
+    for (size_t lane = 0; lane < N; lane++)
+    {
+      T v_min = in_min[idx_in + lane];
+      T v_max = in_max[idx_in + lane];
+      T v_mean = in_mean[idx_in + lane];
+      bool is_valid = (v_mean == v_mean) & !(has_fill & (v_mean == fill));
+      lane_min[lane] = (is_valid & (v_min < lane_min[lane])) ? v_min : lane_min[lane];
+      lane_max[lane] = (is_valid & (v_max > lane_max[lane])) ? v_max : lane_max[lane];
+      lane_sum[lane] += ncstats_lanes_t<T>::mask(static_cast<double>(v_mean), is_valid);
+      lane_nbr[lane] += ncstats_lanes_t<T>::mask(1.0, is_valid);
+    }
+  }
+  memcpy(acc_min, lane_min, sizeof(lane_min));
+  memcpy(acc_max, lane_max, sizeof(lane_max));
+  memcpy(acc_sum, lane_sum, sizeof(lane_sum));
+  memcpy(acc_nbr, lane_nbr, sizeof(lane_nbr));
+}
+
+class ncreduce_t
+{
+public:
+  ncreduce_t(const void *in[3], size_t nbr_rows_in, size_t nbr_cols_in, size_t factor,
+    const std::vector<unsigned char> &fill, nclevel_t &out, size_t row_start, size_t row_end) :
+    m_nbr_rows_in(nbr_rows_in),
+    m_nbr_cols_in(nbr_cols_in),
+    m_factor(factor),
+    m_fill(fill),
+    m_out(out),
+    m_row_start(row_start),
+    m_row_end(row_end)
+  {
+    for (int idx = 0; idx < 3; idx++)
+    {
+      m_in[idx] = in[idx];
+    }
+  }
+  template <typename T>
+  void operator()(const T *)
+  {
+    T fill = T();
+    bool has_fill = (m_fill.size() == sizeof(T));
+    if (has_fill)
+    {
+      memcpy(&fill, &m_fill[0], sizeof(T));
+    }
+    T missing = has_fill ? fill : (std::numeric_limits<T>::has_quiet_NaN ? std::numeric_limits<T>::quiet_NaN() : T());
+    const T *in_min = static_cast<const T*>(m_in[nc_level_min]);
+    const T *in_max = static_cast<const T*>(m_in[nc_level_max]);
+    const T *in_mean = static_cast<const T*>(m_in[nc_level_mean]);
+    T *out_min = reinterpret_cast<T*>(&m_out.m_buf[nc_level_min][0]);
+    T *out_max = reinterpret_cast<T*>(&m_out.m_buf[nc_level_max][0]);
+    T *out_mean = reinterpret_cast<T*>(&m_out.m_buf[nc_level_mean][0]);
+    //columns of input accumulated over the rows of a block (nc_reduce_lanes columns at a time), then
+    //merged in blocks
+    std::vector<T> acc_min(m_nbr_cols_in);
+    std::vector<T> acc_max(m_nbr_cols_in);
+    std::vector<double> acc_sum(m_nbr_cols_in);
+    std::vector<double> acc_nbr(m_nbr_cols_in);
+    size_t nbr_cols_lanes = m_nbr_cols_in / nc_reduce_lanes * nc_reduce_lanes;
+    for (size_t row = m_row_start; row < m_row_end; row++)
+    {
+      size_t row_in_start = row * m_factor;
+      size_t row_in_end = std::min((row + 1) * m_factor, m_nbr_rows_in);
+      for (size_t col_in = 0; col_in < nbr_cols_lanes; col_in += nc_reduce_lanes)
+      {
+        nc_reduce_columns<T, nc_reduce_lanes>(in_min + col_in, in_max + col_in, in_mean + col_in, m_nbr_cols_in,
+          row_in_start, row_in_end, has_fill, fill, &acc_min[col_in], &acc_max[col_in], &acc_sum[col_in], &acc_nbr[col_in]);
+      }
+      for (size_t col_in = nbr_cols_lanes; col_in < m_nbr_cols_in; col_in++)
+      {
+        nc_reduce_columns<T, 1>(in_min + col_in, in_max + col_in, in_mean + col_in, m_nbr_cols_in,
+          row_in_start, row_in_end, has_fill, fill, &acc_min[col_in], &acc_max[col_in], &acc_sum[col_in], &acc_nbr[col_in]);
+      }
+      size_t idx_out = row * m_out.m_nbr_cols;
+      for (size_t col = 0; col < m_out.m_nbr_cols; col++)
+      {
+        size_t col_in_end = std::min((col + 1) * m_factor, m_nbr_cols_in);
+        T val_min = std::numeric_limits<T>::max();
+        T val_max = std::numeric_limits<T>::lowest();
+        double sum = 0;
+        double nbr = 0;
+        for (size_t col_in = col * m_factor; col_in < col_in_end; col_in++)
+        {
+          val_min = std::min(val_min, acc_min[col_in]);
+          val_max = std::max(val_max, acc_max[col_in]);
+          sum += acc_sum[col_in];
+          nbr += acc_nbr[col_in];
+        }
+        out_min[idx_out + col] = (nbr > 0) ? val_min : missing;
+        out_max[idx_out + col] = (nbr > 0) ? val_max : missing;
+        out_mean[idx_out + col] = (nbr > 0) ? static_cast<T>(sum / nbr) : missing;
+      }
+    }
+  }
+  void operator()(const char *)
+  {
+  }
+  void operator()(char* const *)
+  {
+  }
+  const void *m_in[3];
+  size_t m_nbr_rows_in;
+  size_t m_nbr_cols_in;
+  size_t m_factor;
+  const std::vector<unsigned char> &m_fill;
+  nclevel_t &m_out;
+  size_t m_row_start;
+  size_t m_row_end;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncpyramid_t
+//downsampled levels of a layer of nbr_rows x nbr_cols elements; level 1 has a block for each 4x4
+//elements, each next level a block for each 2x2 blocks of the previous one, down to one block;
+//levels take about 1/4 of the layer (3 values for 16 elements, and 1/4 of that for each next level)
+//and are built when first needed, from the layer buffer (not kept, it may be released and read again)
+//the mean of a block of a level above 1 is the mean of the means of its blocks
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncpyramid_t
+{
+public:
+  ncpyramid_t(nc_type nc_typ, size_t nbr_rows, size_t nbr_cols, const std::vector<unsigned char> &fill) :
+    m_nc_type(nc_typ),
+    m_nbr_rows(nbr_rows),
+    m_nbr_cols(nbr_cols),
+    m_fill(fill)
+  {
+  }
+  ~ncpyramid_t()
+  {
+    for (size_t idx = 0; idx < m_level.size(); idx++)
+    {
+      delete m_level[idx];
+    }
+  }
+  //number of levels above the layer; none for layers of less than nc_pyramid_base rows or columns (their
+  //levels would not shrink along both dimensions)
+  size_t size() const
+  {
+    size_t nbr_level = 0;
+    if (m_nbr_rows < nc_pyramid_base || m_nbr_cols < nc_pyramid_base)
+    {
+      return 0;
+    }
+    for (size_t block = nc_pyramid_base; ; block *= 2)
+    {
+      nbr_level++;
+      if (block >= m_nbr_rows && block >= m_nbr_cols)
+      {
+        return nbr_level;
+      }
+    }
+  }
+  //level for a display of elements_per_pixel (layer elements for each pixel), 0 for the layer; the
+  //finest level whose blocks are not smaller than a pixel, so that no element is skipped
+  size_t select(double elements_per_pixel) const
+  {
+    if (elements_per_pixel < 2 || size() == 0)
+    {
+      return 0;
+    }
+    size_t idx_level = 1;
+    for (size_t block = nc_pyramid_base; block < elements_per_pixel && idx_level < size(); block *= 2)
+    {
+      idx_level++;
+    }
+    return idx_level;
+  }
+  //level idx_level (1 to size()), built with the levels below it if needed
+  const nclevel_t* level(size_t idx_level, const void *buf)
+  {
+    while (m_level.size() < idx_level)
+    {
+      build(buf);
+    }
+    return m_level[idx_level - 1];
+  }
+  size_t memory() const
+  {
+    size_t size = 0;
+    for (size_t idx = 0; idx < m_level.size(); idx++)
+    {
+      size += 3 * m_level[idx]->m_buf[0].size();
+    }
+    return size;
+  }
+
+protected:
+  //next level, rows split across cores
+  void build(const void *buf)
+  {
+    const void *in[3] = { buf, buf, buf };
+    size_t nbr_rows_in = m_nbr_rows;
+    size_t nbr_cols_in = m_nbr_cols;
+    size_t factor = nc_pyramid_base;
+    size_t block = nc_pyramid_base;
+    if (!m_level.empty())
+    {
+      const nclevel_t *prev = m_level.back();
+      for (int idx = 0; idx < 3; idx++)
+      {
+        in[idx] = &prev->m_buf[idx][0];
+      }
+      nbr_rows_in = prev->m_nbr_rows;
+      nbr_cols_in = prev->m_nbr_cols;
+      factor = 2;
+      block = prev->m_block * 2;
+    }
+    nclevel_t *level = new nclevel_t((nbr_rows_in + factor - 1) / factor, (nbr_cols_in + factor - 1) / factor,
+      block, nc_type_size(m_nc_type));
+    nc_parallel_for(level->m_nbr_rows, 1, nbr_rows_in * nbr_cols_in >= min_reduce_parallel,
+      [&](size_t, size_t row_start, size_t row_end)
+    {
+      ncreduce_t reduce(in, nbr_rows_in, nbr_cols_in, factor, m_fill, *level, row_start, row_end);
+      nc_visit(m_nc_type, static_cast<const void*>(NULL), reduce);
+    });
+    m_level.push_back(level);
+  }
+  nc_type m_nc_type;
+  size_t m_nbr_rows;
+  size_t m_nbr_cols;
+  std::vector<unsigned char> m_fill;
+  std::vector<nclevel_t*> m_level; // levels built, level 1 first
+private:
+  ncpyramid_t(const ncpyramid_t&);
+  ncpyramid_t& operator=(const ncpyramid_t&);
+};
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef NC_RENDER_HH
+#define NC_RENDER_HH
+
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nccolormap_t
+//RGB of 256 colors; color 0 is for missing values (NaN, _FillValue), colors 1 to 255 go from the
+//minimum to the maximum of the range (viridis, interpolated from control points)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int nc_colormap_size = 256;
+
+class nccolormap_t
+{
+public:
+  nccolormap_t()
+  {
+    static const unsigned char ctl[][3] = { { 68, 1, 84 }, { 72, 40, 120 }, { 62, 74, 137 }, { 49, 104, 142 },
+      { 38, 130, 142 }, { 31, 158, 137 }, { 53, 183, 121 }, { 110, 206, 88 }, { 181, 222, 43 }, { 253, 231, 37 } };
+    const int nbr_ctl = sizeof(ctl) / sizeof(ctl[0]);
+    m_rgb[0] = m_rgb[1] = m_rgb[2] = 160;
+    for (int idx = 1; idx < nc_colormap_size; idx++)
+    {
+      double pos = (idx - 1) * (nbr_ctl - 1) / static_cast<double>(nc_colormap_size - 2);
+      int idx_ctl = std::min(static_cast<int>(pos), nbr_ctl - 2);
+      double frac = pos - idx_ctl;
+      for (int idx_rgb = 0; idx_rgb < 3; idx_rgb++)
+      {
+        m_rgb[idx * 3 + idx_rgb] = static_cast<unsigned char>(ctl[idx_ctl][idx_rgb] * (1 - frac) + ctl[idx_ctl + 1][idx_rgb] * frac + 0.5);
+      }
+    }
+  }
+  unsigned char m_rgb[nc_colormap_size * 3];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncview_t
+//part of a layer shown in an image: element (row, col) at the top left of pixel (0, 0) and elements
+//per pixel along rows and columns; the same view on a pyramid level is divided by its block size
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncview_t
+{
+public:
+  ncview_t(double row0, double col0, double row_scale, double col_scale) :
+    m_row0(row0),
+    m_col0(col0),
+    m_row_scale(row_scale),
+    m_col_scale(col_scale)
+  {
+  }
+  //whole layer of nbr_rows x nbr_cols elements in width x height pixels
+  ncview_t(size_t nbr_rows, size_t nbr_cols, int width, int height) :
+    m_row0(0),
+    m_col0(0),
+    m_row_scale(static_cast<double>(nbr_rows) / height),
+    m_col_scale(static_cast<double>(nbr_cols) / width)
+  {
+  }
+  ncview_t level(size_t block) const
+  {
+    return ncview_t(m_row0 / block, m_col0 / block, m_row_scale / block, m_col_scale / block);
+  }
+  double m_row0;
+  double m_col0;
+  double m_row_scale;
+  double m_col_scale;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncrender_t
+//visitor that renders rows [row_start, row_end) of an image of width x height pixels from a view of
+//a layer of nbr_rows x nbr_cols elements (nearest element); values are first mapped to color indices
+//in blocks of nc_render_lanes into a local array, with selects of values only, so that gcc vectorizes
+//the block at -O2 (not for 64-bit integers), then looked up in the colormap; pixels outside the layer
+//have the color of missing values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int nc_render_lanes = 16;
+
+class ncrender_t
+{
+public:
+  ncrender_t(size_t nbr_rows, size_t nbr_cols, const std::vector<unsigned char> &fill, double val_min, double val_max,
+    const nccolormap_t &colormap, const ncview_t &view, int width, int height, int row_start, int row_end,
+    unsigned char *rgb) :
+    m_nbr_rows(nbr_rows),
+    m_nbr_cols(nbr_cols),
+    m_fill(fill),
+    m_min(val_min),
+    m_scale((val_max > val_min) ? (nc_colormap_size - 2) / (val_max - val_min) : 0),
+    m_colormap(colormap),
+    m_view(view),
+    m_width(width),
+    m_height(height),
+    m_row_start(row_start),
+    m_row_end(row_end),
+    m_rgb(rgb)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    T fill = T();
+    bool has_fill = (m_fill.size() == sizeof(T));
+    if (has_fill)
+    {
+      memcpy(&fill, &m_fill[0], sizeof(T));
+    }
+    std::vector<size_t> col(m_width);
+    std::vector<unsigned char> col_valid(m_width);
+    std::vector<T> val(m_width);
+    std::vector<unsigned char> idx_color(m_width);
+    const double val_min = m_min;
+    const double scale = m_scale;
+    const float pos_max = static_cast<float>(nc_colormap_size - 2);
+    //color index of a value, 0 if missing (position -1)
+    auto color = [&](T v, unsigned char valid) -> unsigned char
+    {
+      bool is_valid = (v == v) & !(has_fill & (v == fill)) & (valid != 0);
+      float pos = static_cast<float>((static_cast<double>(v) - val_min) * scale);
+      pos = (pos > 0.0f) ? pos : 0.0f; //also NaN
+      pos = (pos < pos_max) ? pos : pos_max;
+      pos = is_valid ? pos : -1.0f;
+      return static_cast<unsigned char>(1 + static_cast<int>(pos));
+    };
+    int width_lanes = m_width / nc_render_lanes * nc_render_lanes;
+    for (int idx_col = 0; idx_col < m_width; idx_col++)
+    {
+      double pos = floor(m_view.m_col0 + idx_col * m_view.m_col_scale);
+      col_valid[idx_col] = (pos >= 0 && pos < m_nbr_cols);
+      col[idx_col] = col_valid[idx_col] ? static_cast<size_t>(pos) : 0;
+    }
+    for (int idx_row = m_row_start; idx_row < m_row_end; idx_row++)
+    {
+      unsigned char *out = m_rgb + static_cast<size_t>(idx_row) * m_width * 3;
+      double pos_row = floor(m_view.m_row0 + idx_row * m_view.m_row_scale);
+      if (pos_row < 0 || pos_row >= m_nbr_rows)
+      {
+        for (int idx_col = 0; idx_col < m_width; idx_col++)
+        {
+          memcpy(out + idx_col * 3, m_colormap.m_rgb, 3);
+        }
+        continue;
+      }
+      const T *row = buf + static_cast<size_t>(pos_row) * m_nbr_cols;
+      for (int idx_col = 0; idx_col < m_width; idx_col++)
+      {
+        val[idx_col] = row[col[idx_col]];
+      }
+      for (int idx_col = 0; idx_col < width_lanes; idx_col += nc_render_lanes)
+      {
+        unsigned char idx_lanes[nc_render_lanes];
+        for (int lane = 0; lane < nc_render_lanes; lane++)
+        {
+          idx_lanes[lane] = color(val[idx_col + lane], col_valid[idx_col + lane]);
+        }
+        memcpy(&idx_color[idx_col], idx_lanes, sizeof(idx_lanes));
+      }
+      for (int idx_col = width_lanes; idx_col < m_width; idx_col++)
+      {
+        idx_color[idx_col] = color(val[idx_col], col_valid[idx_col]);
+      }
+      for (int idx_col = 0; idx_col < m_width; idx_col++)
+      {
+        const unsigned char *color = m_colormap.m_rgb + idx_color[idx_col] * 3;
+        out[idx_col * 3] = color[0];
+        out[idx_col * 3 + 1] = color[1];
+        out[idx_col * 3 + 2] = color[2];
+      }
+    }
+  }
+  void operator()(const char *)
+  {
+  }
+  void operator()(char* const *)
+  {
+  }
+  size_t m_nbr_rows;
+  size_t m_nbr_cols;
+  const std::vector<unsigned char> &m_fill;
+  double m_min;
+  double m_scale; // color steps per unit of value
+  const nccolormap_t &m_colormap;
+  ncview_t m_view;
+  int m_width;
+  int m_height;
+  int m_row_start;
+  int m_row_end;
+  unsigned char *m_rgb; // width x height x 3 bytes
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_render_parallel
+//render a view of a layer to width x height RGB pixels, rows split across cores
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int min_render_parallel = 64 * 1024; //pixels
+
+inline void nc_render_parallel(nc_type nc_typ, const void *buf, size_t nbr_rows, size_t nbr_cols,
+  const std::vector<unsigned char> &fill, double val_min, double val_max, const nccolormap_t &colormap,
+  const ncview_t &view, int width, int height, unsigned char *rgb)
+{
+  if (width <= 0 || height <= 0)
+  {
+    return;
+  }
+  nc_parallel_for(height, 1, width * height >= min_render_parallel, [&](size_t, size_t row_start, size_t row_end)
+  {
+    ncrender_t render(nbr_rows, nbr_cols, fill, val_min, val_max, colormap, view, width, height, 
+      static_cast<int>(row_start), static_cast<int>(row_end), rgb);
+    nc_visit(nc_typ, buf, render);
+  });
+}
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef NC_STATS_HH
+#define NC_STATS_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncstats_t
+//range, mean and standard deviation of the valid values of a buffer (not NaN, not _FillValue), and
+//the number of NaN and fill values; statistics of parts (blocks, threads, slabs) are merged with the
+//pairwise update of mean and sum of squared deviations, so that no large sums cancel
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncstats_t
+{
+public:
+  ncstats_t() :
+    m_nbr(0),
+    m_nbr_nan(0),
+    m_nbr_fill(0),
+    m_min(std::numeric_limits<double>::infinity()),
+    m_max(-std::numeric_limits<double>::infinity()),
+    m_mean(0),
+    m_m2(0)
+  {
+  }
+  void merge(const ncstats_t &stats)
+  {
+    if (stats.m_nbr > 0)
+    {
+      double nbr = static_cast<double>(m_nbr + stats.m_nbr);
+      double delta = stats.m_mean - m_mean;
+      m_mean += delta * (stats.m_nbr / nbr);
+      m_m2 += stats.m_m2 + delta * delta * (static_cast<double>(m_nbr) * stats.m_nbr / nbr);
+      m_min = std::min(m_min, stats.m_min);
+      m_max = std::max(m_max, stats.m_max);
+    }
+    m_nbr += stats.m_nbr;
+    m_nbr_nan += stats.m_nbr_nan;
+    m_nbr_fill += stats.m_nbr_fill;
+  }
+  //population standard deviation
+  double stddev() const
+  {
+    return m_nbr ? sqrt(m_m2 / m_nbr) : 0;
+  }
+  size_t m_nbr; // number of valid values
+  size_t m_nbr_nan; // number of NaN
+  size_t m_nbr_fill; // number of _FillValue
+  double m_min;
+  double m_max;
+  double m_mean;
+  double m_m2; // sum of squared deviations from mean
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_is_numeric
+//statistics are defined for numeric types (not NC_CHAR, NC_STRING)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline bool nc_is_numeric(nc_type nc_typ)
+{
+  return nc_typ != NC_CHAR && nc_typ != NC_STRING && nc_type_size(nc_typ) > 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_stats_block
+//statistics of a block small enough to stay in L1 cache, in two passes (range and mean, then squared
+//deviations); each pass keeps nc_stats_lanes independent accumulators and selects instead of
+//branching, so that the compiler vectorizes it without reordering floating point sums
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_stats_lanes = 8;
+const size_t nc_stats_block_size = 4096; //elements
+
+template <typename T>
+class ncstats_lanes_t
+{
+public:
+  ncstats_lanes_t(bool has_fill, T fill) :
+    m_has_fill(has_fill),
+    m_fill(fill),
+    m_mean(0)
+  {
+    for (size_t lane = 0; lane < nc_stats_lanes; lane++)
+    {
+      m_sum[lane] = 0;
+      m_min[lane] = std::numeric_limits<double>::infinity();
+      m_max[lane] = -std::numeric_limits<double>::infinity();
+      m_nbr[lane] = 0;
+      m_nbr_nan[lane] = 0;
+      m_nbr_fill[lane] = 0;
+    }
+  }
+  //first pass
+  void add(size_t lane, T val)
+  {
+    bool is_nan = (val != val);
+    bool is_fill = m_has_fill & (val == m_fill);
+    bool is_valid = !(is_nan | is_fill);
+    double val_dbl = static_cast<double>(val);
+    m_nbr_nan[lane] += is_nan;
+    m_nbr_fill[lane] += is_fill;
+    m_nbr[lane] += is_valid;
+    m_sum[lane] += mask(val_dbl, is_valid);
+    m_min[lane] = (is_valid & (val_dbl < m_min[lane])) ? val_dbl : m_min[lane];
+    m_max[lane] = (is_valid & (val_dbl > m_max[lane])) ? val_dbl : m_max[lane];
+  }
+  //second pass, m_sum holds squared deviations from m_mean
+  void add_dev(size_t lane, T val)
+  {
+    bool is_valid = (val == val) & !(m_has_fill & (val == m_fill));
+    double dev = static_cast<double>(val) - m_mean;
+    m_sum[lane] += mask(dev * dev, is_valid);
+  }
+  //val if keep, otherwise 0, without a branch (a select before an add is compiled as a branch)
+  static double mask(double val, bool keep)
+  {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    bits &= 0 - static_cast<uint64_t>(keep);
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+  }
+  bool m_has_fill;
+  T m_fill;
+  double m_mean;
+  double m_sum[nc_stats_lanes];
+  double m_min[nc_stats_lanes];
+  double m_max[nc_stats_lanes];
+  size_t m_nbr[nc_stats_lanes];
+  size_t m_nbr_nan[nc_stats_lanes];
+  size_t m_nbr_fill[nc_stats_lanes];
+};
+
+template <typename T>
+inline void nc_stats_block(const T *buf, size_t nbr, bool has_fill, T fill, ncstats_t &stats)
+{
+  ncstats_lanes_t<T> lanes(has_fill, fill);
+  size_t nbr_lanes = nbr / nc_stats_lanes * nc_stats_lanes;
+  for (size_t idx = 0; idx < nbr_lanes; idx += nc_stats_lanes)
+  {
+    for (size_t lane = 0; lane < nc_stats_lanes; lane++)
+    {
+      lanes.add(lane, buf[idx + lane]);
+    }
+  }
+  for (size_t idx = nbr_lanes; idx < nbr; idx++)
+  {
+    lanes.add(idx - nbr_lanes, buf[idx]);
+  }
+
+  ncstats_t block;
+  double sum = 0;
+  for (size_t lane = 0; lane < nc_stats_lanes; lane++)
+  {
+    block.m_nbr += lanes.m_nbr[lane];
+    block.m_nbr_nan += lanes.m_nbr_nan[lane];
+    block.m_nbr_fill += lanes.m_nbr_fill[lane];
+    block.m_min = std::min(block.m_min, lanes.m_min[lane]);
+    block.m_max = std::max(block.m_max, lanes.m_max[lane]);
+    sum += lanes.m_sum[lane];
+    lanes.m_sum[lane] = 0;
+  }
+  if (block.m_nbr > 0)
+  {
+    block.m_mean = sum / block.m_nbr;
+    lanes.m_mean = block.m_mean;
+    for (size_t idx = 0; idx < nbr_lanes; idx += nc_stats_lanes)
+    {
+      for (size_t lane = 0; lane < nc_stats_lanes; lane++)
+      {
+        lanes.add_dev(lane, buf[idx + lane]);
+      }
+    }
+    for (size_t idx = nbr_lanes; idx < nbr; idx++)
+    {
+      lanes.add_dev(idx - nbr_lanes, buf[idx]);
+    }
+    for (size_t lane = 0; lane < nc_stats_lanes; lane++)
+    {
+      block.m_m2 += lanes.m_sum[lane];
+    }
+  }
+  stats.merge(block);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncstats_kernel_t
+//visitor that adds the statistics of nbr elements of a buffer, block by block; fill holds the bytes
+//of _FillValue (empty if none)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncstats_kernel_t
+{
+public:
+  ncstats_kernel_t(size_t nbr, const std::vector<unsigned char> &fill, ncstats_t &stats) :
+    m_nbr(nbr),
+    m_fill(fill),
+    m_stats(stats)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    T fill = T();
+    bool has_fill = (m_fill.size() == sizeof(T));
+    if (has_fill)
+    {
+      memcpy(&fill, &m_fill[0], sizeof(T));
+    }
+    for (size_t idx = 0; idx < m_nbr; idx += nc_stats_block_size)
+    {
+      nc_stats_block(buf + idx, std::min(nc_stats_block_size, m_nbr - idx), has_fill, fill, m_stats);
+    }
+  }
+  void operator()(const char *)
+  {
+  }
+  void operator()(char* const *)
+  {
+  }
+  size_t m_nbr;
+  const std::vector<unsigned char> &m_fill;
+  ncstats_t &m_stats;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_stats_parallel
+//add the statistics of nbr elements of buf to stats; large buffers are split in one contiguous part
+//per core and the parts are merged in order, so that the result does not depend on scheduling
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t min_stats_parallel = 256 * 1024; //elements
+
+inline void nc_stats_parallel(nc_type nc_typ, const void *buf, size_t nbr, const std::vector<unsigned char> &fill,
+  ncstats_t &stats)
+{
+  if (nbr < min_stats_parallel || nc_parallel_threads() < 2)
+  {
+    ncstats_kernel_t kernel(nbr, fill, stats);
+    nc_visit(nc_typ, buf, kernel);
+    return;
+  }
+  size_t type_size = nc_type_size(nc_typ);
+  std::vector<ncstats_t> parts(nc_parallel_threads());
+  nc_parallel_for(nbr, nc_stats_block_size, true, [&](size_t idx_part, size_t start, size_t end)
+  {
+    ncstats_kernel_t kernel(end - start, fill, parts[idx_part]);
+    nc_visit(nc_typ, static_cast<const void*>(static_cast<const char*>(buf) + start * type_size), kernel);
+  });
+  for (size_t idx_part = 0; idx_part < parts.size(); idx_part++)
+  {
+    stats.merge(parts[idx_part]);
+  }
+}
+
+#endif
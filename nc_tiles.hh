@@ -0,0 +1,143 @@
+#ifndef NC_TILES_HH
+#define NC_TILES_HH
+
+#include <list>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include "nc_data.hh"
+#include "nc_cache.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nctile_reader_t
+//reads a tile of nbr_rows x nbr_cols elements at (row, col) of a layer, in rows x columns order;
+//returns an empty buffer on error
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class nctile_reader_t
+{
+public:
+  virtual ~nctile_reader_t()
+  {
+  }
+  virtual ncbuf_t read(size_t row, size_t col, size_t nbr_rows, size_t nbr_cols) = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nctiles_t
+//out-of-core access to a layer too large to be read whole: the layer is divided in tiles of about
+//nc_tile_size bytes, read on demand and kept in a least recently used list; tiles are charged to
+//the cache, whose budget bounds them together with the buffers and the tiles of other views (the
+//tile last read is always kept); tiles are as wide as the layer up to nc_tile_cols columns, so that
+//a grid scrolled down reads contiguous rows
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_tile_size = 1024 * 1024; //bytes
+const size_t nc_tile_cols = 1024; //elements
+
+class nctiles_t
+{
+public:
+  nctiles_t(nc_type nc_typ, size_t nbr_rows, size_t nbr_cols, nccache_t &cache, nctile_reader_t *reader) :
+    m_resident(0),
+    m_cache(cache),
+    m_nc_type(nc_typ),
+    m_nbr_rows(nbr_rows),
+    m_nbr_cols(nbr_cols),
+    m_reader(reader)
+  {
+    m_tile_cols = std::max<size_t>(1, std::min(nbr_cols, nc_tile_cols));
+    m_tile_rows = std::max<size_t>(1, nc_tile_size / (m_tile_cols * nc_type_size(nc_typ)));
+  }
+
+  ~nctiles_t()
+  {
+    clear();
+  }
+
+  //buffer of the tile of element (row, col), and index of the element in it; NULL if not read
+  const void* at(size_t row, size_t col, size_t &idx)
+  {
+    size_t row_tile = row / m_tile_rows;
+    size_t col_tile = col / m_tile_cols;
+    tile_t *tile = find(row_tile, col_tile);
+    if (tile == NULL || tile->m_buf.empty())
+    {
+      return NULL;
+    }
+    idx = (row - row_tile * m_tile_rows) * tile->m_nbr_cols + (col - col_tile * m_tile_cols);
+    return tile->m_buf.data();
+  }
+
+  //layer changed, all tiles are released
+  void clear()
+  {
+    m_lru.clear();
+    m_index.clear();
+    m_cache.discharge(m_resident);
+    m_resident = 0;
+  }
+
+  size_t m_resident; // bytes of resident tiles
+
+protected:
+  class tile_t
+  {
+  public:
+    tile_t(size_t row_tile, size_t col_tile, size_t nbr_cols, ncbuf_t buf) :
+      m_row_tile(row_tile),
+      m_col_tile(col_tile),
+      m_nbr_cols(nbr_cols),
+      m_buf(std::move(buf))
+    {
+    }
+    size_t m_row_tile; // index of tile (rows)
+    size_t m_col_tile; // index of tile (columns)
+    size_t m_nbr_cols; // columns in tile (last tiles are narrower)
+    ncbuf_t m_buf;
+  };
+
+  //get tile, read if needed, and make it the most recently used; least recently used tiles are
+  //released while the cache is over budget (the tile returned is always kept)
+  tile_t* find(size_t row_tile, size_t col_tile)
+  {
+    std::pair<size_t, size_t> key(row_tile, col_tile);
+    std::map<std::pair<size_t, size_t>, std::list<tile_t>::iterator>::iterator it = m_index.find(key);
+    if (it != m_index.end())
+    {
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+      return &m_lru.front();
+    }
+    size_t row = row_tile * m_tile_rows;
+    size_t col = col_tile * m_tile_cols;
+    size_t nbr_rows = std::min(m_tile_rows, m_nbr_rows - row);
+    size_t nbr_cols = std::min(m_tile_cols, m_nbr_cols - col);
+    m_lru.push_front(tile_t(row_tile, col_tile, nbr_cols, m_reader->read(row, col, nbr_rows, nbr_cols)));
+    m_index[key] = m_lru.begin();
+    size_t size = m_lru.front().m_buf.size() * nc_type_size(m_nc_type);
+    m_resident += size;
+    m_cache.charge(size);
+    while (m_cache.m_resident > m_cache.m_budget && m_lru.size() > 1)
+    {
+      tile_t &tile = m_lru.back();
+      size = tile.m_buf.size() * nc_type_size(m_nc_type);
+      m_resident -= size;
+      m_cache.discharge(size);
+      m_index.erase(std::make_pair(tile.m_row_tile, tile.m_col_tile));
+      m_lru.pop_back();
+    }
+    return &m_lru.front();
+  }
+
+  nccache_t &m_cache; // budget shared with buffers and other tiles
+  nc_type m_nc_type;
+  size_t m_nbr_rows; // size of layer
+  size_t m_nbr_cols;
+  size_t m_tile_rows; // size of tiles
+  size_t m_tile_cols;
+  nctile_reader_t *m_reader;
+  std::list<tile_t> m_lru; // most recently used first
+  std::map<std::pair<size_t, size_t>, std::list<tile_t>::iterator> m_index;
+};
+
+#endif
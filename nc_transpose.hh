@@ -0,0 +1,93 @@
+#ifndef NC_TRANSPOSE_HH
+#define NC_TRANSPOSE_HH
+
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <netcdf.h>
+#include "nc_data.hh"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nctranspose_t
+//visitor that gathers rows [row_start, row_end) of a layer of nbr_rows x nbr_cols elements, element
+//(row, col) at offset + row * stride_rows + col * stride_cols of the input, to a contiguous layer
+//(row-major); when columns are not contiguous the copy goes in tiles of nc_transpose_block x
+//nc_transpose_block elements, so that the cache lines read along a column of a tile are used by
+//the next columns of the tile instead of being evicted by a whole row
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t nc_transpose_block = 64; //elements on each side of a tile
+const size_t min_transpose_parallel = 1024 * 1024; //elements
+
+class nctranspose_t
+{
+public:
+  nctranspose_t(size_t offset, size_t stride_rows, size_t stride_cols, size_t nbr_cols, size_t row_start, size_t row_end,
+    void *out) :
+    m_offset(offset),
+    m_stride_rows(stride_rows),
+    m_stride_cols(stride_cols),
+    m_nbr_cols(nbr_cols),
+    m_row_start(row_start),
+    m_row_end(row_end),
+    m_out(out)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    const T *in = buf + m_offset;
+    T *out = static_cast<T*>(m_out);
+    if (m_stride_cols == 1)
+    {
+      for (size_t row = m_row_start; row < m_row_end; row++)
+      {
+        memcpy(out + row * m_nbr_cols, in + row * m_stride_rows, m_nbr_cols * sizeof(T));
+      }
+      return;
+    }
+    for (size_t row_tile = m_row_start; row_tile < m_row_end; row_tile += nc_transpose_block)
+    {
+      size_t row_end = std::min(row_tile + nc_transpose_block, m_row_end);
+      for (size_t col_tile = 0; col_tile < m_nbr_cols; col_tile += nc_transpose_block)
+      {
+        size_t col_end = std::min(col_tile + nc_transpose_block, m_nbr_cols);
+        for (size_t row = row_tile; row < row_end; row++)
+        {
+          const T *in_row = in + row * m_stride_rows;
+          T *out_row = out + row * m_nbr_cols;
+          for (size_t col = col_tile; col < col_end; col++)
+          {
+            out_row[col] = in_row[col * m_stride_cols];
+          }
+        }
+      }
+    }
+  }
+  size_t m_offset;
+  size_t m_stride_rows;
+  size_t m_stride_cols;
+  size_t m_nbr_cols;
+  size_t m_row_start;
+  size_t m_row_end;
+  void *m_out; // nbr_rows x nbr_cols elements
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_transpose_parallel
+//gather a strided layer to a contiguous buffer, tiles of rows split across cores
+//NC_STRING pointers are copied, not the strings
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline void nc_transpose_parallel(nc_type nc_typ, const void *buf, size_t offset, size_t stride_rows, size_t stride_cols,
+  size_t nbr_rows, size_t nbr_cols, void *out)
+{
+  nc_parallel_for(nbr_rows, nc_transpose_block, nbr_rows * nbr_cols >= min_transpose_parallel, 
+    [&](size_t, size_t row_start, size_t row_end)
+  {
+    nctranspose_t transpose(offset, stride_rows, stride_cols, nbr_cols, row_start, row_end, out);
+    nc_visit(nc_typ, buf, transpose);
+  });
+}
+
+#endif
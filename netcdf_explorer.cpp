@@ -13,14 +13,37 @@
 #include "wx/config.h"
 #include "wx/toolbar.h"
 #include "wx/cmdline.h"
+#include "wx/timer.h"
+#include "wx/thread.h"
+#include "wx/msgqueue.h"
+#include "wx/stopwatch.h"
 #include "icons/sample.xpm"
 #include "icons/back.xpm"
 #include "icons/forward.xpm"
 #include "icons/doc_blue.xpm"
 #include <algorithm>
 #include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
 #include "netcdf.h"
 #include "nc_data.hh"
+#include "nc_cache.hh"
+#include "nc_coord.hh"
+#include "nc_pool.hh"
+#include "nc_format.hh"
+#include "nc_stats.hh"
+#include "nc_render.hh"
+#include "nc_pyramid.hh"
+#include "nc_mmap.hh"
+#include "nc_transpose.hh"
+#include "nc_pack.hh"
+#include "nc_find.hh"
+#include "nc_tiles.hh"
 
 
 //OPeNDAP
@@ -36,7 +59,22 @@ enum
   ID_DIMENSIONS_ROWS,
   ID_DIMENSIONS_COLS,
   ID_DIMENSIONS_LAYERS,
-  ID_CHILD_QUIT
+  ID_CHILD_QUIT,
+  ID_TIMER_POOL,
+  ID_FRAME_CANCEL_LOAD,
+  ID_LOAD_PROGRESS,
+  ID_LOAD_DONE,
+  ID_OPEN_DONE,
+  ID_CHILD_STATS,
+  ID_STATS_DONE,
+  ID_CHILD_IMAGE,
+  ID_CHILD_IMAGE_MODE,
+  ID_CHILD_FIND,
+  ID_CHILD_FIND_NEXT,
+  ID_FIND_DONE,
+  ID_FIND_OP,
+  ID_FIND_VAL,
+  ID_FIND_VAL_MAX
 };
 
 //Widget IDs for layer navigation 
@@ -84,11 +122,294 @@ public:
       }
     }
   }
+  //dimensions displayed by rows and by columns (Dimensions dialog), the others by layers in order
+  void set(size_t nbr_dmn, int dim_rows, int dim_cols)
+  {
+    m_dim_rows = dim_rows;
+    m_dim_cols = dim_cols;
+    m_dim_layers.clear();
+    for (size_t idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
+    {
+      if (static_cast<int>(idx_dmn) != dim_rows && static_cast<int>(idx_dmn) != dim_cols)
+      {
+        m_dim_layers.push_back(idx_dmn);
+      }
+    }
+  }
   int m_dim_rows;   // choose dimension to be displayed by rows 
   int m_dim_cols;   // choose dimension to be displayed by columns 
   std::vector<int> m_dim_layers; // choose dimensions to be displayed by layers 
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncstride_t
+//strided view of a variable buffer (row-major, as read by the library) for a grid policy; element 
+//(row, col) of a layer is at offset(layer) + row * m_stride_rows + col * m_stride_cols, for any rank; 
+//strides are computed once when the view is built
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ncstride_t
+{
+public:
+  ncstride_t() :
+    m_stride_rows(0),
+    m_stride_cols(0)
+  {
+  }
+  ncstride_t(const std::vector<ncdim_t> &ncdim, const grid_policy_t &grid_policy) :
+    m_stride_rows(0),
+    m_stride_cols(0)
+  {
+    std::vector<size_t> stride(ncdim.size(), 1);
+    for (size_t idx_dmn = ncdim.size(); idx_dmn > 1; idx_dmn--)
+    {
+      stride[idx_dmn - 2] = stride[idx_dmn - 1] * ncdim[idx_dmn - 1].m_size;
+    }
+    if (grid_policy.m_dim_rows >= 0)
+    {
+      m_stride_rows = stride[grid_policy.m_dim_rows];
+    }
+    if (grid_policy.m_dim_cols >= 0)
+    {
+      m_stride_cols = stride[grid_policy.m_dim_cols];
+    }
+    for (size_t idx_dmn = 0; idx_dmn < grid_policy.m_dim_layers.size(); idx_dmn++)
+    {
+      m_stride_layers.push_back(stride[grid_policy.m_dim_layers[idx_dmn]]);
+    }
+  }
+  //layer buffer of nbr_cols columns (layer mode)
+  ncstride_t(size_t nbr_cols) :
+    m_stride_rows(nbr_cols),
+    m_stride_cols(1)
+  {
+  }
+  //index of element (0, 0) of a layer (indices of the layer dimensions)
+  size_t offset(const std::vector<int> &layer) const
+  {
+    size_t idx_buf = 0;
+    for (size_t idx_dmn = 0; idx_dmn < layer.size() && idx_dmn < m_stride_layers.size(); idx_dmn++)
+    {
+      idx_buf += layer[idx_dmn] * m_stride_layers[idx_dmn];
+    }
+    return idx_buf;
+  }
+  size_t at(size_t offset, int row, int col) const
+  {
+    return offset + row * m_stride_rows + col * m_stride_cols;
+  }
+  std::vector<size_t> m_stride_layers; // elements between consecutive indices of each layer dimension
+  size_t m_stride_rows; // elements between rows
+  size_t m_stride_cols; // elements between columns
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_cache
+//all variable and coordinate buffers loaded from the tree, bounded by a memory budget
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const long default_cache_size = 1024; //MB
+nccache_t nc_cache(default_cache_size * 1024 * 1024);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//IsLoadLayer
+//variables of rank above 2 larger than max_load_size, or of any rank larger than the cache budget, 
+//are not read whole; only the layer currently displayed is read (hyperslab), or, if the layer itself 
+//exceeds the cache budget, the tiles of it being displayed (IsLoadTile); statistics, search and batch 
+//output stream them from file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t max_chunk_cache_size = 256 * 1024 * 1024; //bytes, chunk cache for a variable read by layers
+const size_t max_load_size = 64 * 1024 * 1024; //bytes
+
+bool IsLoadLayer(const ncvar_t *ncvar)
+{
+  size_t var_size = ncvar->size() * ncvar->type_size();
+  return (ncvar->m_ncdim.size() > 2 && var_size > max_load_size) || 
+    (ncvar->m_ncdim.size() > 0 && var_size > nc_cache.m_budget);
+}
+
+bool IsLoadTile(const ncvar_t *ncvar, const grid_policy_t &grid_policy)
+{
+  size_t layer_size = ncvar->type_size();
+  if (grid_policy.m_dim_rows >= 0)
+  {
+    layer_size *= ncvar->m_ncdim[grid_policy.m_dim_rows].m_size;
+  }
+  if (grid_policy.m_dim_cols >= 0)
+  {
+    layer_size *= ncvar->m_ncdim[grid_policy.m_dim_cols].m_size;
+  }
+  return IsLoadLayer(ncvar) && layer_size > nc_cache.m_budget;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//TransposeLayer
+//a layer read as a hyperslab is in the order of the variable dimensions, columns x rows when the 
+//dimension of rows comes after the dimension of columns; returns it as rows x columns in a new 
+//buffer (buf is freed, NC_STRING pointers are moved), empty if out of memory
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ncbuf_t TransposeLayer(ncbuf_t buf, size_t nbr_rows, size_t nbr_cols)
+{
+  if (buf.empty())
+  {
+    return buf;
+  }
+  nc_type nc_typ = buf.type();
+  ncbuf_t out(nc_typ, nbr_rows * nbr_cols);
+  if (!out.empty())
+  {
+    nc_transpose_parallel(nc_typ, buf.data(), 0, 1, nbr_rows, nbr_rows, nbr_cols, out.data());
+    buf.reset_moved();
+  }
+  return out;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_coord
+//coordinate variables of the items, one per (file, group, dimension), their buffers are in nc_cache
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+nccoord_t nc_coord;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_mutex
+//the netCDF library is not thread-safe; every netCDF call (and nc_pool use) holds this lock
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxMutex nc_mutex;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_pool
+//files opened by the tree and the grids are kept open for reuse
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t max_pool_open = 16; //files
+const time_t max_pool_idle = 300; //seconds
+ncpool_t nc_pool(max_pool_open, max_pool_idle);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nc_mmap
+//with --mmap, classic format files (CDF-1, CDF-2, CDF-5) are mapped in memory and their variables are
+//shown from the mapping, without reading them into buffers; a mapping is shared by the items of a 
+//file and unmapped when the last one is deleted; files that cannot be mapped are not tried again
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool nc_mmap_enabled = false;
+std::map<std::string, std::weak_ptr<ncmmap_t> > nc_mmap_file; // mappings by file name (nc_mutex held)
+std::set<std::string> nc_mmap_fail; // files that could not be mapped (nc_mutex held)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//MapFile
+//mapping of a classic format file, shared; NULL if the file cannot be mapped
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<ncmmap_t> MapFile(const wxString &file_name)
+{
+  std::string name(file_name.mb_str());
+  if (nc_mmap_fail.count(name))
+  {
+    return std::shared_ptr<ncmmap_t>();
+  }
+  std::shared_ptr<ncmmap_t> mmap = nc_mmap_file[name].lock();
+  if (mmap == NULL)
+  {
+    mmap.reset(new ncmmap_t);
+    if (mmap->open(name.c_str()) != NC_NOERR)
+    {
+      nc_mmap_file.erase(name);
+      nc_mmap_fail.insert(name);
+      return std::shared_ptr<ncmmap_t>();
+    }
+    nc_mmap_file[name] = mmap;
+  }
+  return mmap;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//GetCacheStatus
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString GetCacheStatus()
+{
+  return wxString::Format(wxT("Cache: %.1f of %.0f MB resident, %lu hits, %lu misses"),
+    nc_cache.m_resident / (1024.0 * 1024.0),
+    nc_cache.m_budget / (1024.0 * 1024.0),
+    static_cast<unsigned long>(nc_cache.m_nbr_hit),
+    static_cast<unsigned long>(nc_cache.m_nbr_miss));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//GetStorageInfo
+//chunk geometry and filters of a variable
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString GetStorageInfo(const ncvar_t *ncvar)
+{
+  if (ncvar->m_chunk.empty())
+  {
+    return wxT("contiguous");
+  }
+  wxString str(wxT("chunks "));
+  for (size_t idx_dmn = 0; idx_dmn < ncvar->m_chunk.size(); idx_dmn++)
+  {
+    str += wxString::Format(wxT("%s%lu"), idx_dmn ? wxT("x") : wxT(""), static_cast<unsigned long>(ncvar->m_chunk[idx_dmn]));
+  }
+  if (ncvar->m_deflate)
+  {
+    str += wxString::Format(wxT(", deflate %d"), ncvar->m_deflate);
+  }
+  if (ncvar->m_shuffle)
+  {
+    str += wxT(", shuffle");
+  }
+  return str;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//GetReadRows
+//number of indices of the first dimension to read from index row of a variable chunked with chunk, 
+//about nbr_row_chunk; unless the end is reached, the read ends on a chunk boundary, so that each 
+//chunk is read (decompressed) once 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t GetReadRows(const std::vector<size_t> &chunk, size_t row, size_t nbr_row_chunk, size_t nbr_row_left)
+{
+  size_t nbr_row_read = std::min(nbr_row_chunk, nbr_row_left);
+  if (chunk.empty() || chunk[0] <= 1 || nbr_row_read == nbr_row_left)
+  {
+    return nbr_row_read;
+  }
+  size_t row_end = (row + nbr_row_read) / chunk[0] * chunk[0];
+  if (row_end <= row)
+  {
+    row_end = (row / chunk[0] + 1) * chunk[0];
+  }
+  return std::min(row_end - row, nbr_row_left);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//SetChunkCache
+//make the chunk cache of a variable at least size bytes for nbr_chunk chunks; only set when smaller,
+//since setting it empties the cache
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SetChunkCache(int grp_id, int var_id, size_t size, size_t nbr_chunk)
+{
+  size_t size_cur;
+  size_t nbr_slot;
+  float preemption;
+  if (size == 0 || nc_get_var_chunk_cache(grp_id, var_id, &size_cur, &nbr_slot, &preemption) != NC_NOERR || size_cur >= size)
+  {
+    return;
+  }
+  if (nc_set_var_chunk_cache(grp_id, var_id, size, std::max(nbr_slot, 10 * nbr_chunk + 1), preemption) != NC_NOERR)
+  {
+
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //GetAppName
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -123,6 +444,16 @@ wxString GetPathComponent(const wxString &path)
   return name;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//OpenGroup
+//obtain file ID and ID of group with full name from the pool of open files; IDs are owned by the pool
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int OpenGroup(const char *file_name, const char *grp_nm_fll, int *nc_id, int *grp_id)
+{
+  return nc_pool.open_group(file_name, grp_nm_fll, nc_id, grp_id);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //wxItemData
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -138,35 +469,251 @@ public:
     Attribute
   };
 
-  wxItemData(ItemKind kind, const wxString& file_name, const wxString& grp_nm_fll, const wxString& item_nm, wxItemData *item_data_prn,
+  wxItemData(ItemKind kind, const char *file_name, const char *grp_nm_fll, const char *item_nm, wxItemData *item_data_prn,
     ncvar_t *ncvar, grid_policy_t *grid_policy) :
-    m_file_name(file_name),
-    m_grp_nm_fll(grp_nm_fll),
-    m_item_nm(item_nm),
+    m_file_name(nc_intern(file_name)),
+    m_grp_nm_fll(nc_intern(grp_nm_fll)),
+    m_item_nm(nc_intern(item_nm)),
     m_kind(kind),
     m_item_data_prn(item_data_prn),
     m_ncvar(ncvar),
-    m_grid_policy(grid_policy)
+    m_grid_policy(grid_policy),
+    m_mmap_var(NULL),
+    m_pack_read(false),
+    m_iterated(false)
   {
   }
   ~wxItemData()
   {
+    nc_cache.erase(m_ncvar);
     delete m_ncvar;
     for (size_t idx_dmn = 0; idx_dmn < m_ncvar_crd.size(); idx_dmn++)
     {
-      delete m_ncvar_crd[idx_dmn];
+      if (m_ncvar_crd[idx_dmn] != NULL && nc_coord.release(m_ncvar_crd[idx_dmn]))
+      {
+        nc_cache.erase(m_ncvar_crd[idx_dmn]);
+        delete m_ncvar_crd[idx_dmn];
+      }
     }
     delete m_grid_policy;
   }
-  wxString m_file_name;  // (Root/Variable/Group/Attribute) file name
-  wxString m_grp_nm_fll; // (Group) full name of group
-  wxString m_item_nm; // (Root/Variable/Group/Attribute ) item name to display on tree
+  //(Variable) dimensions of rows, columns and layers, defined when first shown
+  grid_policy_t* GetGridPolicy()
+  {
+    if (m_grid_policy == NULL)
+    {
+      m_grid_policy = new grid_policy_t(m_ncvar->m_ncdim);
+    }
+    return m_grid_policy;
+  }
+  const char *m_file_name;  // (Root/Variable/Group/Attribute) file name (interned)
+  const char *m_grp_nm_fll; // (Group) full name of group (interned)
+  const char *m_item_nm; // (Root/Variable/Group/Attribute ) item name to display on tree (interned)
   ItemKind m_kind; // (Root/Variable/Group/Attribute) type of item 
-  std::vector<wxString> m_var_nms; // (Group) list of variables if item is group (filled in file iteration)
+  std::unordered_map<const char*, int> m_var_ids; // (Group) variable IDs by interned name (filled in file iteration)
   wxItemData *m_item_data_prn; //  (Variable/Group) item data of the parent group (to get list of variables in group)
   ncvar_t *m_ncvar; // (Variable) netCDF variable to display
-  std::vector<ncvar_t *> m_ncvar_crd; // (Variable) optional coordinate variables for variable
-  grid_policy_t *m_grid_policy; // (Variable) current grid policy (interactive)
+  std::vector<ncvar_t *> m_ncvar_crd; // (Variable) optional coordinate variables for variable (shared, in nc_coord)
+  grid_policy_t *m_grid_policy; // (Variable) current grid policy (interactive), NULL until GetGridPolicy
+  std::shared_ptr<ncmmap_t> m_mmap; // (Variable) mapped file (--mmap, classic format), NULL if not mapped
+  const ncmmap_var_t *m_mmap_var; // (Variable) variable in m_mmap, shown without a buffer
+  ncpack_t m_pack; // (Variable) scale_factor, add_offset and missing values, values shown unpacked
+  bool m_pack_read; // (Variable) m_pack read (first load)
+  bool m_iterated; // (Root/Group) children appended; a group is iterated when first expanded
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ncload_t
+//a variable buffer (or a layer prefetched by a grid) read in background by wxThreadLoad; 
+//created and deleted in the GUI thread, the worker only reads the file names and fills the buffer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t min_async_size = 4 * 1024 * 1024; //variables larger than this (bytes) are read in background
+const size_t load_chunk_size = 4 * 1024 * 1024; //bytes read per lock of nc_mutex
+
+class wxGridLayers;
+
+class ncload_t
+{
+public:
+  //whole variable
+  ncload_t(wxItemData *item_data) :
+    m_item_data(item_data),
+    m_grid(NULL),
+    m_file_name(item_data->m_file_name),
+    m_grp_nm_fll(item_data->m_grp_nm_fll),
+    m_var_nm(item_data->m_item_nm),
+    m_nc_type(item_data->m_ncvar->m_nc_type),
+    m_ncdim(item_data->m_ncvar->m_ncdim),
+    m_chunk(item_data->m_ncvar->m_chunk),
+    m_chunk_cache(0),
+    m_chunk_nbr(0),
+    m_mmap(item_data->m_mmap),
+    m_mmap_var(item_data->m_mmap_var),
+    m_transpose(false),
+    m_status(NC_NOERR),
+    m_time(0),
+    m_cancel(false)
+  {
+    for (size_t idx_dmn = 0; idx_dmn < m_ncdim.size(); idx_dmn++)
+    {
+      m_start.push_back(0);
+      m_count.push_back(m_ncdim[idx_dmn].m_size);
+    }
+  }
+  //layer of a grid, hyperslab start and count, buffer dimensions 
+  ncload_t(wxItemData *item_data, wxGridLayers *grid, const std::vector<int> &layer,
+    const std::vector<size_t> &start, const std::vector<size_t> &count, const std::vector<ncdim_t> &ncdim) :
+    m_item_data(item_data),
+    m_grid(grid),
+    m_layer(layer),
+    m_file_name(item_data->m_file_name),
+    m_grp_nm_fll(item_data->m_grp_nm_fll),
+    m_var_nm(item_data->m_item_nm),
+    m_nc_type(item_data->m_ncvar->m_nc_type),
+    m_ncdim(ncdim),
+    m_start(start),
+    m_count(count),
+    m_chunk(item_data->m_ncvar->m_chunk),
+    m_chunk_cache(0),
+    m_chunk_nbr(0),
+    m_mmap(item_data->m_mmap),
+    m_mmap_var(item_data->m_mmap_var),
+    m_transpose(false),
+    m_status(NC_NOERR),
+    m_time(0),
+    m_cancel(false)
+  {
+  }
+  void Cancel()
+  {
+    wxCriticalSectionLocker lock(m_cs);
+    m_cancel = true;
+  }
+  bool IsCancelled()
+  {
+    wxCriticalSectionLocker lock(m_cs);
+    return m_cancel;
+  }
+  wxItemData *m_item_data; // (GUI thread only) item that receives the buffer 
+  wxGridLayers *m_grid; // (GUI thread only) grid that receives a prefetched layer, NULL for whole variable
+  std::vector<int> m_layer; // layer prefetched
+  std::string m_file_name;
+  std::string m_grp_nm_fll;
+  std::string m_var_nm;
+  nc_type m_nc_type;
+  std::vector<ncdim_t> m_ncdim; // dimensions of buffer
+  std::vector<size_t> m_start; // hyperslab
+  std::vector<size_t> m_count;
+  std::vector<size_t> m_chunk; // chunk sizes of variable
+  size_t m_chunk_cache; // chunk cache size to set (bytes), 0 for default
+  size_t m_chunk_nbr; // number of chunks in chunk cache
+  std::shared_ptr<ncmmap_t> m_mmap; // mapped file, read instead of the library if not NULL
+  const ncmmap_var_t *m_mmap_var; // variable in m_mmap
+  bool m_transpose; // (layer) read as columns x rows, transposed by the worker (TransposeLayer)
+  ncbuf_t m_buf; // buffer read, freed if not handed to the item (cancelled or failed)
+  int m_status; // netCDF status of read
+  long m_time; // time to read (milliseconds)
+
+protected:
+  wxCriticalSection m_cs;
+  bool m_cancel;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadLoad
+//background I/O worker; reads queued loads in chunks along the first dimension and posts 
+//ID_LOAD_PROGRESS and ID_LOAD_DONE thread events to the handler; a NULL load ends the thread
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxThreadLoad : public wxThread
+{
+public:
+  wxThreadLoad(wxEvtHandler *handler) :
+    wxThread(wxTHREAD_JOINABLE),
+    m_handler(handler)
+  {
+  }
+  wxMessageQueue<ncload_t*> m_queue; // loads to read
+
+protected:
+  virtual ExitCode Entry();
+  void Read(ncload_t *load);
+  wxEvtHandler *m_handler;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadScan
+//scan of a whole variable for a view; the buffer is scanned when resident (pinned by the view), 
+//otherwise the variable is streamed from file (StreamLoad) and scanned by hyperslabs; Scan is called 
+//for each range of elements, in order, and returns false to stop; posts id_done to the handler
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxThreadScan : public wxThread
+{
+public:
+  wxThreadScan(wxEvtHandler *handler, int id_done, wxItemData *item_data) :
+    wxThread(wxTHREAD_JOINABLE),
+    m_load(new ncload_t(item_data)),
+    m_buf(IsLoadLayer(item_data->m_ncvar) ? NULL : item_data->m_ncvar->m_buf),
+    m_fill(item_data->m_ncvar->m_fill),
+    m_pack(item_data->m_pack),
+    m_handler(handler),
+    m_id_done(id_done)
+  {
+  }
+  ~wxThreadScan()
+  {
+    delete m_load;
+  }
+  ncload_t *m_load; // variable to stream, cancelled when the view is closed
+  const void *m_buf; // resident buffer, NULL to stream
+  std::vector<unsigned char> m_fill; // _FillValue of variable
+  ncpack_t m_pack; // packing of variable, values unpacked before the scan
+
+protected:
+  virtual ExitCode Entry();
+  virtual bool Scan(const void *buf, size_t idx, size_t nbr) = 0;
+  wxEvtHandler *m_handler;
+  int m_id_done; // thread event posted when done
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadStats
+//statistics of a whole variable for the statistics pane of a view; posts ID_STATS_DONE
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxThreadStats : public wxThreadScan
+{
+public:
+  wxThreadStats(wxEvtHandler *handler, wxItemData *item_data) :
+    wxThreadScan(handler, ID_STATS_DONE, item_data)
+  {
+  }
+  ncstats_t m_stats; // result
+
+protected:
+  virtual bool Scan(const void *buf, size_t idx, size_t nbr);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadFind
+//search of a value in a whole variable for the Find tool of a view; posts ID_FIND_DONE
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxThreadFind : public wxThreadScan
+{
+public:
+  wxThreadFind(wxEvtHandler *handler, wxItemData *item_data, const ncfind_t &find) :
+    wxThreadScan(handler, ID_FIND_DONE, item_data),
+    m_find(find)
+  {
+  }
+  ncfind_t m_find; // condition
+  std::vector<size_t> m_hits; // result, indices in variable (up to max_find_hits)
+
+protected:
+  virtual bool Scan(const void *buf, size_t idx, size_t nbr);
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -181,23 +728,86 @@ public:
   void OnSelChanged(wxTreeEvent& event);
   void OnItemActivated(wxTreeEvent& event);
   void OnItemMenu(wxTreeEvent& event);
+  void OnItemExpanding(wxTreeEvent& event);
+  void OnItemGetToolTip(wxTreeEvent& event);
   void OnLoadItem(wxCommandEvent& event);
   void OnDimensions(wxCommandEvent& event);
   void OnUpdateDimensions(wxUpdateUIEvent& event);
+  static int LoadVariable(const int nc_id, const int var_id, const nc_type var_type, size_t buf_sz, ncbuf_t &buf,
+    const size_t *start = NULL, const size_t *count = NULL);
+  static int ReadVariable(const int nc_id, const int var_id, const nc_type var_type,
+    const size_t *start, const size_t *count, void *buf);
+
+  static int LoadItem(wxItemData *item_data, bool load_var = true);
 
 protected:
-  void LoadItem(wxItemData *item_data);
   void ShowVariable(wxItemData *item_data);
-  void* LoadVariable(const int nc_id, const int var_id, const nc_type var_type, size_t buf_sz);
 
 private:
   wxDECLARE_EVENT_TABLE();
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogDimensions
+//choice of the dimensions of a variable displayed by rows and by columns; the other dimensions are
+//displayed by layers
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxDialogDimensions : public wxDialog
+{
+public:
+  wxDialogDimensions(wxWindow *parent, const ncvar_t *ncvar, const grid_policy_t &grid_policy);
+  void OnChoice(wxCommandEvent& event);
+  void OnUpdateOK(wxUpdateUIEvent& event);
+  int GetRows() const
+  {
+    return m_choice_rows->GetSelection();
+  }
+  int GetCols() const
+  {
+    return m_choice_cols->GetSelection();
+  }
+
+protected:
+  const ncvar_t *m_ncvar;
+  wxChoice *m_choice_rows;
+  wxChoice *m_choice_cols;
+  wxStaticText *m_text_layers; // dimensions left for layers
+  void UpdateLayers();
+
+private:
+  DECLARE_EVENT_TABLE()
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogFind
+//condition of a value search in a variable (Find tool of a view)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxDialogFind : public wxDialog
+{
+public:
+  wxDialogFind(wxWindow *parent, const ncvar_t *ncvar, const ncfind_t &find);
+  void OnUpdateOK(wxUpdateUIEvent& event);
+  void OnUpdateVal(wxUpdateUIEvent& event);
+  void OnUpdateValMax(wxUpdateUIEvent& event);
+  bool GetFind(ncfind_t &find) const;
+
+protected:
+  wxChoice *m_choice_op; // in the order of nc_find_equal ... nc_find_nan
+  wxTextCtrl *m_text_val;
+  wxTextCtrl *m_text_val_max; // (range) maximum
+
+private:
+  DECLARE_EVENT_TABLE()
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //wxFrameExplorer
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
+class wxFrameChild;
+
 class wxFrameExplorer : public wxMDIParentFrame
 {
 public:
@@ -210,19 +820,37 @@ public:
   void OnSize(wxSizeEvent& event);
   void OnSashDrag(wxSashEvent& event);
   void OnAbout(wxCommandEvent& event);
+  void OnTimerPool(wxTimerEvent& event);
+  void OnCancelLoad(wxCommandEvent& event);
+  void OnLoadProgress(wxThreadEvent& event);
+  void OnLoadDone(wxThreadEvent& event);
+  void StartLoad(wxItemData *item_data);
+  void QueueLoad(ncload_t *load);
+  void CancelLoad(wxItemData *item_data, wxFrameChild *frame_closed);
   int GetSashWidth()
   {
     wxRect rect = m_sash->GetRect();
     return rect.GetWidth();
   };
-  int OpenFile(const wxString& file_name);
+  void OpenFile(const wxString& file_name);
+  void OpenFiles(const wxArrayString& file_names);
+  void OnOpenDone(wxThreadEvent& event);
+  void ExpandGroup(wxTreeItemId item_id);
+  static int ScanGroup(const int grp_id, ncgrp_t &grp);
 
 protected:
-  int Iterate(const wxString& file_name, const int grp_id, wxTreeItemId item_id);
+  void AppendGroup(const char *file_name, ncgrp_t &grp, wxTreeItemId item_id);
   wxTreeCtrlExplorer *m_tree;
   wxSashLayoutWindow *m_sash;
   wxTreeItemId m_tree_root;
   wxFileHistory m_file_history;
+  wxTimer m_timer_pool; // close files idle in pool
+  wxThreadLoad *m_thread_load; // background reads of variables
+  wxMessageQueue<ncopen_t*> m_queue_open; // files to open
+  wxThreadOpen *m_thread_open; // open worker
+  std::vector<ncopen_t*> m_open; // files queued or being scanned
+  std::vector<ncload_t*> m_load; // loads queued or in progress
+  std::vector<wxFrameChild*> GetFrameChildren();
 
   //tree icons
   enum
@@ -248,11 +876,11 @@ public:
   virtual bool OnCmdLineParsed(wxCmdLineParser& parser);
 
 protected:
-  wxString m_file_name;
+  wxArrayString m_file_names;
 };
 
 DECLARE_APP(wxAppExplorer)
-IMPLEMENT_APP(wxAppExplorer)
+IMPLEMENT_APP_NO_MAIN(wxAppExplorer)
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //wxAppExplorer::OnInit
@@ -264,9 +892,9 @@ bool wxAppExplorer::OnInit()
     return false;
 
   wxFrameExplorer *frame = new wxFrameExplorer();
-  if (!m_file_name.empty())
+  if (!m_file_names.empty())
   {
-    frame->OpenFile(m_file_name);
+    frame->OpenFiles(m_file_names);
   }
   frame->Show(true);
   frame->Maximize();
@@ -280,7 +908,10 @@ bool wxAppExplorer::OnInit()
 void wxAppExplorer::OnInitCmdLine(wxCmdLineParser& parser)
 {
   wxApp::OnInitCmdLine(parser);
-  parser.AddParam("input file", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL);
+  parser.AddOption("c", "cache", "memory budget of cache for loaded variables (MB)", wxCMD_LINE_VAL_NUMBER);
+  parser.AddSwitch("", "batch", "print to stdout without GUI (--batch --help for options)");
+  parser.AddSwitch("", "mmap", "show variables of netCDF-3 files from the file mapped in memory");
+  parser.AddParam("input files", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -292,37 +923,151 @@ bool wxAppExplorer::OnCmdLineParsed(wxCmdLineParser& parser)
   if (!wxApp::OnCmdLineParsed(parser))
     return false;
 
-  if (parser.GetParamCount())
+  long cache_size;
+  if (parser.Found("cache", &cache_size) && cache_size > 0)
+  {
+    nc_cache.set_budget(static_cast<size_t>(cache_size) * 1024 * 1024);
+  }
+  nc_mmap_enabled = parser.Found("mmap");
+
+  for (size_t idx_prm = 0; idx_prm < parser.GetParamCount(); idx_prm++)
   {
-    m_file_name = parser.GetParam(0);
+    m_file_names.Add(parser.GetParam(idx_prm));
   }
 
   return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxGridLayers
+//wxGridTableLayers
+//virtual table for wxGridLayers; values and labels are read from the netCDF buffers
+//and formatted only when the grid requests them for painting
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-class wxGridLayers : public wxGrid
+class wxGridTableLayers : public wxGridTableBase
 {
 public:
-  wxGridLayers(wxWindow *parent, const wxSize& size, wxItemData *item_data);
-  ~wxGridLayers();
-  void ShowGrid();
-
-public:
-  std::vector<int> m_layer;  // current selected layer of a dimension > 2 
-  wxItemData *m_item_data; // the tree item that generated this grid (convenience pointer to data in wxItemData)
-  ncvar_t *m_ncvar; // netCDF variable to display (convenience pointer to data in wxItemData)
-  wxString GetFormat(const nc_type typ);
-
-protected:
+  wxGridTableLayers(ncvar_t *ncvar, const std::vector<ncvar_t *> &ncvar_crd,
+    int dim_rows, int dim_cols, int nbr_rows, int nbr_cols);
+  virtual int GetNumberRows()
+  {
+    return m_nbr_rows;
+  }
+  virtual int GetNumberCols()
+  {
+    return m_nbr_cols;
+  }
+  virtual bool IsEmptyCell(int WXUNUSED(row), int WXUNUSED(col))
+  {
+    return false;
+  }
+  virtual wxString GetValue(int row, int col);
+  virtual void SetValue(int WXUNUSED(row), int WXUNUSED(col), const wxString& WXUNUSED(value))
+  {
+    //read only
+  }
+  virtual wxString GetRowLabelValue(int row);
+  virtual wxString GetColLabelValue(int col);
+  wxString GetValueUnpack(int row, int col);
+  void SetLayer(size_t idx_buf, const ncstride_t &stride)
+  {
+    m_idx_buf = idx_buf;
+    m_stride = stride;
+  }
+  void SetVariable(ncvar_t *ncvar)
+  {
+    m_ncvar = ncvar;
+    m_format = ncformat_t(ncvar->m_nc_type);
+  }
+  //values formatted from the mapped file, as stored (big-endian)
+  void SetMap(const ncmmap_t *mmap, const ncmmap_var_t *mmap_var)
+  {
+    m_mmap = mmap;
+    m_mmap_var = mmap_var;
+    m_format = ncformat_t(mmap_var->m_nc_type, true);
+  }
+  //values unpacked (scale_factor, add_offset) before formatting, missing values shown as "_"
+  void SetPack(const ncpack_t &pack)
+  {
+    m_pack = pack;
+    m_format_unpack = ncformat_t(pack.m_nc_type);
+  }
+  //values read by tiles of the layer (layer larger than the cache budget)
+  void SetTiles(nctiles_t *tiles)
+  {
+    m_tiles = tiles;
+  }
+
+protected:
+  ncvar_t *m_ncvar; // netCDF variable to display 
+  std::vector<ncvar_t *> m_ncvar_crd; // optional coordinate variables for variable 
+  int m_dim_rows;   // dimension displayed by rows 
+  int m_dim_cols;   // dimension displayed by columns 
+  int m_nbr_rows;   // number of rows
+  int m_nbr_cols;   // number of columns
+  size_t m_idx_buf; // index in buffer of the first element of the current layer
+  ncstride_t m_stride; // strides of rows and columns in buffer
+  ncformat_t m_format; // formatter for type of variable
+  std::string m_str; // last value formatted
+  const ncmmap_t *m_mmap; // (map mode) mapped file
+  const ncmmap_var_t *m_mmap_var; // (map mode) variable in mapped file, NULL if not mapped
+  ncpack_t m_pack; // packing of variable, values formatted as stored if not unpacked
+  ncformat_t m_format_unpack; // formatter for type of unpacked values
+  std::vector<ncformat_t> m_format_crd; // formatters for types of coordinate variables, for labels
+  nctiles_t *m_tiles; // (tile mode) tiles of the layer (owned by the grid), NULL if not tiled
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxGridLayers : public wxGrid
+{
+public:
+  wxGridLayers(wxWindow *parent, const wxSize& size, wxItemData *item_data);
+  ~wxGridLayers();
+  void ShowGrid();
+
+public:
+  std::vector<int> m_layer;  // current selected layer of a dimension > 2 
+  grid_policy_t m_grid_policy; // dimensions of rows, columns and layers when the grid was created
+  wxItemData *m_item_data; // the tree item that generated this grid (convenience pointer to data in wxItemData)
+  ncvar_t *m_ncvar; // netCDF variable to display (convenience pointer to data in wxItemData)
+  static wxString GetFormat(const nc_type typ);
+  void Prefetch(size_t idx_dmn, int dir);
+  void StoreLayer(ncload_t *load);
+  ncvar_t* GetLayer(size_t &idx_buf, size_t &nbr);
+  ncbuf_t ReadTile(size_t row, size_t col, size_t nbr_rows, size_t nbr_cols);
+  //layer read by tiles, not resident as a whole (no image or layer statistics)
+  bool IsTiled() const
+  {
+    return m_tiles != NULL;
+  }
+
+protected:
   int m_nbr_rows;   // number of rows
   int m_nbr_cols;   // number of columns
   int m_dim_rows;   // choose rows (convenience duplicate to data in wxItemData)
   int m_dim_cols;   // choose columns (convenience duplicate to data in wxItemData)
   std::vector<ncvar_t *> m_ncvar_crd; // optional coordinate variables for variable (convenience duplicate to data in wxItemData)
+  wxGridTableLayers *m_table; // virtual table (owned by the grid)
+  ncstride_t m_stride; // strided view of the variable buffer
+  ncvar_t *m_ncvar_layer; // (layer mode) current layer, in m_layer_buf
+  size_t m_idx_layer; // index in buffer of the first element of the current layer
+  std::map<std::vector<int>, ncvar_t *> m_layer_buf; // (layer mode) layers read, current and prefetched 
+  std::map<std::vector<int>, ncload_t *> m_layer_load; // (layer mode) layers being prefetched
+  ncvar_t *m_ncvar_unpack; // (packed variable) current layer unpacked, NULL if none
+  std::vector<int> m_layer_unpack; // (packed variable) layer in m_ncvar_unpack
+  wxStopWatch m_watch_step; // time of layer steps
+  long m_time_step; // time of last step (milliseconds)
+  long m_time_read; // average time to read a layer (milliseconds)
+  size_t m_chunk_cache; // (layer mode) chunk cache size for layer reads (bytes), 0 for default
+  size_t m_chunk_nbr; // (layer mode) number of chunks in chunk cache
+  nctile_reader_t *m_tile_reader; // (tile mode) reads tiles of the current layer
+  nctiles_t *m_tiles; // (tile mode) tiles read, NULL if not tiled
+  ncvar_t* LoadLayer(const std::vector<int> &layer);
+  ncvar_t* GetLayerStored(size_t &idx_buf, size_t &nbr);
+  void GetLayerSlab(const std::vector<int> &layer, std::vector<size_t> &start, std::vector<size_t> &count);
 
 private:
   DECLARE_EVENT_TABLE()
@@ -331,17 +1076,49 @@ private:
 wxBEGIN_EVENT_TABLE(wxGridLayers, wxGrid)
 wxEND_EVENT_TABLE()
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nctile_grid_t
+//tiles of the current layer of a grid, read by wxGridLayers::ReadTile
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class nctile_grid_t : public nctile_reader_t
+{
+public:
+  nctile_grid_t(wxGridLayers *grid) :
+    m_grid(grid)
+  {
+  }
+  virtual ncbuf_t read(size_t row, size_t col, size_t nbr_rows, size_t nbr_cols)
+  {
+    return m_grid->ReadTile(row, col, nbr_rows, nbr_cols);
+  }
+
+protected:
+  wxGridLayers *m_grid;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //wxGridLayers::wxGridLayers
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 wxGridLayers::wxGridLayers(wxWindow *parent, const wxSize& size, wxItemData *item_data) :
   wxGrid(parent, wxID_ANY, wxPoint(0, 0), size, wxNO_BORDER),
+  m_grid_policy(*item_data->GetGridPolicy()),
   m_item_data(item_data),
   m_ncvar(item_data->m_ncvar),
-  m_dim_rows(item_data->m_grid_policy->m_dim_rows),
-  m_dim_cols(item_data->m_grid_policy->m_dim_cols),
-  m_ncvar_crd(item_data->m_ncvar_crd)
+  m_dim_rows(m_grid_policy.m_dim_rows),
+  m_dim_cols(m_grid_policy.m_dim_cols),
+  m_ncvar_crd(item_data->m_ncvar_crd),
+  m_stride(item_data->m_ncvar->m_ncdim, m_grid_policy),
+  m_ncvar_layer(NULL),
+  m_idx_layer(0),
+  m_ncvar_unpack(NULL),
+  m_time_step(0),
+  m_time_read(0),
+  m_chunk_cache(0),
+  m_chunk_nbr(0),
+  m_tile_reader(NULL),
+  m_tiles(NULL)
 {
   //currently selected layers for dimensions greater than two are the first layer
   if (m_ncvar->m_ncdim.size() > 2)
@@ -364,16 +1141,54 @@ wxGridLayers::wxGridLayers(wxWindow *parent, const wxSize& size, wxItemData *ite
   else if (m_ncvar->m_ncdim.size() == 1)
   {
     assert(m_dim_rows == 0);
-    m_nbr_rows = m_ncvar->m_ncdim[m_dim_rows].m_size;
+    m_nbr_rows = static_cast<int>(std::min<size_t>(m_ncvar->m_ncdim[m_dim_rows].m_size, INT_MAX));
     m_nbr_cols = 1;
   }
   else
   {
-    m_nbr_rows = m_ncvar->m_ncdim[m_dim_rows].m_size;
-    m_nbr_cols = m_ncvar->m_ncdim[m_dim_cols].m_size;
+    m_nbr_rows = static_cast<int>(std::min<size_t>(m_ncvar->m_ncdim[m_dim_rows].m_size, INT_MAX));
+    m_nbr_cols = static_cast<int>(std::min<size_t>(m_ncvar->m_ncdim[m_dim_cols].m_size, INT_MAX));
+  }
+
+  //chunk cache for layer reads: chunks of one layer, twice (prefetch crosses chunk boundaries of 
+  //the layer dimensions); reading a layer decompresses all its chunks, stepping to the next layers 
+  //reuses them until a chunk boundary
+  if (IsLoadLayer(m_ncvar) && !m_ncvar->m_chunk.empty())
+  {
+    size_t chunk_size = m_ncvar->type_size();
+    for (size_t idx_dmn = 0; idx_dmn < m_ncvar->m_chunk.size(); idx_dmn++)
+    {
+      chunk_size *= m_ncvar->m_chunk[idx_dmn];
+    }
+    m_chunk_nbr = 2 * ((m_nbr_rows + m_ncvar->m_chunk[m_dim_rows] - 1) / m_ncvar->m_chunk[m_dim_rows]);
+    if (m_dim_cols >= 0)
+    {
+      m_chunk_nbr *= (m_nbr_cols + m_ncvar->m_chunk[m_dim_cols] - 1) / m_ncvar->m_chunk[m_dim_cols];
+    }
+    m_chunk_cache = std::min(max_chunk_cache_size, m_chunk_nbr * chunk_size);
+  }
+
+  //tile mode, the layer is larger than the cache budget: tiles are read as cells are painted, charged
+  //to the cache with the buffers and the tiles of other views
+  if (IsLoadTile(m_ncvar, m_grid_policy) && m_item_data->m_mmap_var == NULL)
+  {
+    m_tile_reader = new nctile_grid_t(this);
+    m_tiles = new nctiles_t(m_ncvar->m_nc_type, m_nbr_rows, m_nbr_cols, nc_cache, m_tile_reader);
   }
 
-  this->CreateGrid(m_nbr_rows, m_nbr_cols);
+  //virtual table, cells are formatted on demand
+  m_table = new wxGridTableLayers(m_ncvar, m_ncvar_crd, m_dim_rows, m_dim_cols, m_nbr_rows, m_nbr_cols);
+  if (m_item_data->m_mmap_var != NULL)
+  {
+    m_table->SetMap(m_item_data->m_mmap.get(), m_item_data->m_mmap_var);
+  }
+  if (m_item_data->m_pack.is_unpacked())
+  {
+    m_table->SetPack(m_item_data->m_pack);
+  }
+  m_table->SetTiles(m_tiles);
+  this->SetTable(m_table, true);
+  this->EnableEditing(false);
 
   //show data
   this->ShowGrid();
@@ -385,9 +1200,88 @@ wxGridLayers::wxGridLayers(wxWindow *parent, const wxSize& size, wxItemData *ite
 
 wxGridLayers::~wxGridLayers()
 {
-
+  for (std::map<std::vector<int>, ncload_t *>::iterator it = m_layer_load.begin(); it != m_layer_load.end(); ++it)
+  {
+    it->second->Cancel();
+  }
+  for (std::map<std::vector<int>, ncvar_t *>::iterator it = m_layer_buf.begin(); it != m_layer_buf.end(); ++it)
+  {
+    delete it->second;
+  }
+  delete m_ncvar_unpack;
+  delete m_tiles;
+  delete m_tile_reader;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//nclayer_image_t
+//pyramid and statistics of a layer shown as image, kept for the last layers shown so that zoom, pan 
+//and stepping back do not scan the layer again
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t max_image_layers = 4;
+
+class nclayer_image_t
+{
+public:
+  nclayer_image_t(const std::vector<int> &layer, nc_type nc_typ, size_t nbr_rows, size_t nbr_cols,
+    const std::vector<unsigned char> &fill) :
+    m_layer(layer),
+    m_pyramid(nc_typ, nbr_rows, nbr_cols, fill),
+    m_stats_done(false)
+  {
+  }
+  std::vector<int> m_layer; // index of layer
+  ncpyramid_t m_pyramid;
+  ncstats_t m_stats; // of layer
+  bool m_stats_done; // m_stats computed
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers
+//image view of the current layer of a grid (the grid of the same view holds the layer), rendered 
+//at the size of the window through a colormap; alternative to the grid for large layers
+//the mouse wheel zooms around the pointer, dragging pans and a right click shows the whole layer;
+//when an element is smaller than a pixel the view is rendered from the pyramid level of that 
+//resolution (min, max or mean of blocks), not from the layer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class wxImageLayers : public wxWindow
+{
+public:
+  wxImageLayers(wxWindow *parent, wxGridLayers *grid);
+  ~wxImageLayers();
+  void Render();
+  void SetRange(double val_min, double val_max);
+  void SetMode(int mode);
+  void OnPaint(wxPaintEvent& event);
+  void OnSize(wxSizeEvent& event);
+  void OnLeftDClick(wxMouseEvent& event);
+  void OnLeftDown(wxMouseEvent& event);
+  void OnMotion(wxMouseEvent& event);
+  void OnMouseWheel(wxMouseEvent& event);
+  void OnRightDown(wxMouseEvent& event);
+  static wxBitmap GetToolBitmap();
+
+protected:
+  wxGridLayers *m_grid; // grid of the view, holds the current layer
+  nccolormap_t m_colormap;
+  std::vector<unsigned char> m_rgb; // pixels rendered
+  wxBitmap m_bitmap;
+  bool m_range_var; // colors span the range of the variable (otherwise of each layer)
+  double m_min; // range of variable
+  double m_max;
+  std::vector<nclayer_image_t*> m_layer_image; // last layers shown, most recent last
+  int m_mode; // values of pyramid levels shown, nc_level_min, nc_level_max or nc_level_mean
+  bool m_fit; // whole layer shown (otherwise m_view, zoomed or panned)
+  ncview_t m_view;
+  wxPoint m_drag; // last position of mouse while dragging
+  nclayer_image_t* GetLayerImage(const ncvar_t *ncvar_layer, size_t nbr_rows, size_t nbr_cols);
+
+private:
+  DECLARE_EVENT_TABLE()
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //wxFrameChild
 //version 3.0 does not have toolbars for wxMDIChildFrame
@@ -397,15 +1291,45 @@ class wxFrameChild : public wxFrame
 {
 public:
   wxFrameChild(wxMDIParentFrame *parent, const wxString& title, wxItemData *item_data);
+  ~wxFrameChild();
   void OnQuit(wxCommandEvent& event);
   void OnActivate(wxActivateEvent& event);
   void OnForward(wxCommandEvent& event);
   void OnBack(wxCommandEvent& event);
   void OnChoiceLayer(wxCommandEvent &event);
+  void OnStats(wxCommandEvent& event);
+  void OnStatsDone(wxThreadEvent& event);
+  void OnImage(wxCommandEvent& event);
+  void OnChoiceImageMode(wxCommandEvent& event);
+  void OnFind(wxCommandEvent& event);
+  void OnFindNext(wxCommandEvent& event);
+  void OnFindDone(wxThreadEvent& event);
+  void OnUpdateFind(wxUpdateUIEvent& event);
+  void OnUpdateFindNext(wxUpdateUIEvent& event);
+  void ShowCell(int row, int col);
+  void ShowIndex(size_t idx_var);
+  void UpdateGrid();
+  wxItemData* GetItemData()
+  {
+    return m_item_data;
+  }
 
 protected:
+  wxSplitterWindow *m_splitter; // grid, and statistics pane when shown
   wxGridLayers *m_grid;
+  wxImageLayers *m_image; // image view (rank 2 or more), shown instead of the grid
+  wxTextCtrl *m_stats; // statistics pane
+  wxItemData *m_item_data; // the tree item shown (buffers pinned in cache while open)
+  wxThreadStats *m_thread_stats; // statistics of variable being computed
+  ncstats_t m_stats_var; // statistics of variable
+  bool m_stats_var_done; // m_stats_var computed
+  wxThreadFind *m_thread_find; // search in variable being done
+  ncfind_t m_find; // condition of last search
+  bool m_find_done; // m_find entered
+  std::vector<size_t> m_find_hits; // indices in variable found by last search
+  size_t m_find_idx; // hit shown
   void InitToolBar(wxToolBar* tb, wxItemData *item_data);
+  void UpdateStats();
 
 private:
   DECLARE_EVENT_TABLE()
@@ -417,29 +1341,58 @@ private:
 
 wxBEGIN_EVENT_TABLE(wxFrameChild, wxFrame)
 EVT_MENU(ID_CHILD_QUIT, wxFrameChild::OnQuit)
-EVT_TOOL(ID_CHILD_FORWARD, wxFrameChild::OnForward)
-EVT_TOOL(ID_CHILD_FORWARD + 1, wxFrameChild::OnForward)
-EVT_TOOL(ID_CHILD_FORWARD + 2, wxFrameChild::OnForward)
-EVT_TOOL(ID_CHILD_BACK, wxFrameChild::OnBack)
-EVT_TOOL(ID_CHILD_BACK + 1, wxFrameChild::OnBack)
-EVT_TOOL(ID_CHILD_BACK + 2, wxFrameChild::OnBack)
-EVT_CHOICE(ID_CHILD_INDEX_LAYER, wxFrameChild::OnChoiceLayer)
-EVT_CHOICE(ID_CHILD_INDEX_LAYER + 1, wxFrameChild::OnChoiceLayer)
-EVT_CHOICE(ID_CHILD_INDEX_LAYER + 2, wxFrameChild::OnChoiceLayer)
+EVT_TOOL_RANGE(ID_CHILD_FORWARD, ID_CHILD_FORWARD + max_dimension - 1, wxFrameChild::OnForward)
+EVT_TOOL_RANGE(ID_CHILD_BACK, ID_CHILD_BACK + max_dimension - 1, wxFrameChild::OnBack)
+EVT_COMMAND_RANGE(ID_CHILD_INDEX_LAYER, ID_CHILD_INDEX_LAYER + max_dimension - 1, wxEVT_COMMAND_CHOICE_SELECTED, wxFrameChild::OnChoiceLayer)
+EVT_TOOL(ID_CHILD_STATS, wxFrameChild::OnStats)
+EVT_TOOL(ID_CHILD_IMAGE, wxFrameChild::OnImage)
+EVT_CHOICE(ID_CHILD_IMAGE_MODE, wxFrameChild::OnChoiceImageMode)
+EVT_THREAD(ID_STATS_DONE, wxFrameChild::OnStatsDone)
+EVT_TOOL(ID_CHILD_FIND, wxFrameChild::OnFind)
+EVT_TOOL(ID_CHILD_FIND_NEXT, wxFrameChild::OnFindNext)
+EVT_THREAD(ID_FIND_DONE, wxFrameChild::OnFindDone)
+EVT_UPDATE_UI(ID_CHILD_FIND, wxFrameChild::OnUpdateFind)
+EVT_UPDATE_UI(ID_CHILD_FIND_NEXT, wxFrameChild::OnUpdateFindNext)
 wxEND_EVENT_TABLE()
 
 wxFrameChild::wxFrameChild(wxMDIParentFrame *parent, const wxString& title, wxItemData *item_data) :
   wxFrame(parent, wxID_ANY, title, wxDefaultPosition, wxDefaultSize,
-    wxDEFAULT_FRAME_STYLE | wxNO_FULL_REPAINT_ON_RESIZE | wxFRAME_FLOAT_ON_PARENT)
+    wxDEFAULT_FRAME_STYLE | wxNO_FULL_REPAINT_ON_RESIZE | wxFRAME_FLOAT_ON_PARENT),
+  m_image(NULL),
+  m_item_data(item_data),
+  m_thread_stats(NULL),
+  m_stats_var_done(false),
+  m_thread_find(NULL),
+  m_find_done(false),
+  m_find_idx(0)
 {
+  //buffers in use by this view are not evicted from cache
+  nc_cache.pin(item_data->m_ncvar);
+  for (size_t idx_dmn = 0; idx_dmn < item_data->m_ncvar_crd.size(); idx_dmn++)
+  {
+    if (item_data->m_ncvar_crd[idx_dmn] != NULL)
+    {
+      nc_cache.pin(item_data->m_ncvar_crd[idx_dmn]);
+    }
+  }
   SetIcon(wxICON(sample));
-  m_grid = new wxGridLayers(this, GetClientSize(), item_data);
-  //3D variable, add a layer navigation toolbar with extra dimensions above rows and columns
-  if (item_data->m_ncvar->m_ncdim.size() >= 3)
+  m_splitter = new wxSplitterWindow(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxSP_3D | wxSP_LIVE_UPDATE);
+  m_splitter->SetSashGravity(1.0);
+  m_splitter->SetMinimumPaneSize(20);
+  m_grid = new wxGridLayers(m_splitter, GetClientSize(), item_data);
+  if (item_data->m_ncvar->m_ncdim.size() >= 2 && nc_is_numeric(item_data->m_ncvar->m_nc_type) && !m_grid->IsTiled())
   {
-    CreateToolBar(wxNO_BORDER | wxTB_FLAT | wxTB_HORIZONTAL, wxID_ANY, "layer");
-    InitToolBar(GetToolBar(), item_data);
+    m_image = new wxImageLayers(m_splitter, m_grid);
+    m_image->Hide();
   }
+  m_stats = new wxTextCtrl(m_splitter, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+    wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP | wxHSCROLL);
+  m_stats->SetFont(wxFont(9, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+  m_stats->Hide();
+  m_splitter->Initialize(m_grid);
+  //toolbar with statistics and, for 3D variables, layer navigation with extra dimensions above rows and columns
+  CreateToolBar(wxNO_BORDER | wxTB_FLAT | wxTB_HORIZONTAL, wxID_ANY, "layer");
+  InitToolBar(GetToolBar(), item_data);
   Raise();
   //nicely rearranje children under parent frame
   wxPoint pos = GetPosition();
@@ -455,117 +1408,112 @@ wxFrameChild::wxFrameChild(wxMDIParentFrame *parent, const wxString& title, wxIt
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameChild::~wxFrameChild
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxFrameChild::~wxFrameChild()
+{
+  if (m_thread_stats != NULL)
+  {
+    m_thread_stats->m_load->Cancel();
+    m_thread_stats->Wait();
+    delete m_thread_stats;
+  }
+  if (m_thread_find != NULL)
+  {
+    m_thread_find->m_load->Cancel();
+    m_thread_find->Wait();
+    delete m_thread_find;
+  }
+  nc_cache.unpin(m_item_data->m_ncvar);
+  for (size_t idx_dmn = 0; idx_dmn < m_item_data->m_ncvar_crd.size(); idx_dmn++)
+  {
+    if (m_item_data->m_ncvar_crd[idx_dmn] != NULL)
+    {
+      nc_cache.unpin(m_item_data->m_ncvar_crd[idx_dmn]);
+    }
+  }
+  nc_cache.trim();
+  wxFrameExplorer *frame = (wxFrameExplorer*)GetParent();
+  if (!frame->IsBeingDeleted())
+  {
+    frame->CancelLoad(m_item_data, this);
+    frame->SetStatusText(GetCacheStatus());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameChild::UpdateGrid
+//buffer was read in background, show it
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameChild::UpdateGrid()
+{
+  m_grid->ShowGrid();
+  m_grid->Refresh();
+  if (m_image != NULL && m_image->IsShown())
+  {
+    m_image->Render();
+  }
+  UpdateStats();
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 //wxFrameChild::InitToolBar
-//add dimension choices for variables with rank greater than 2
+//statistics pane toggle, and dimension choices for variables with rank greater than 2
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void wxFrameChild::InitToolBar(wxToolBar* tb, wxItemData *item_data)
 {
-  float *buf_float = NULL;
-  double *buf_double = NULL;
-  int *buf_int = NULL;
-  short *buf_short = NULL;
-  signed char *buf_byte = NULL;
-  unsigned char *buf_ubyte = NULL;
-  unsigned short *buf_ushort = NULL;
-  unsigned int *buf_uint = NULL;
-  long long *buf_int64 = NULL;
-  unsigned long long *buf_uint64 = NULL;
-
 #if defined (__WXMSW__)
   tb->SetToolBitmapSize(tb->GetToolBitmapSize() + wxSize(0, 10));
 #endif
 
-  //number of dimensions above a two-dimensional dataset
-  for (size_t idx_dmn = 0; idx_dmn < m_grid->m_layer.size(); idx_dmn++)
+  tb->AddCheckTool(ID_CHILD_STATS, wxT("Statistics"), wxArtProvider::GetBitmap(wxART_REPORT_VIEW, wxART_TOOLBAR),
+    wxNullBitmap, wxT("Show statistics of layer and variable."));
+  if (m_image != NULL)
+  {
+    tb->AddCheckTool(ID_CHILD_IMAGE, wxT("Image"), wxImageLayers::GetToolBitmap(), wxNullBitmap, wxT("Show layer as image."));
+    //values shown when elements are smaller than pixels, in the order of nc_level_min, nc_level_max, nc_level_mean
+    wxArrayString vec_mode;
+    vec_mode.Add("min");
+    vec_mode.Add("max");
+    vec_mode.Add("mean");
+    wxChoice *choice_mode = new wxChoice(tb, ID_CHILD_IMAGE_MODE, wxDefaultPosition, wxSize(70, 30), vec_mode);
+    choice_mode->SetSelection(nc_level_mean);
+    choice_mode->SetToolTip(wxT("Value of blocks of elements smaller than a pixel."));
+    tb->AddControl(choice_mode);
+  }
+  if (nc_is_numeric(item_data->m_ncvar->m_nc_type))
+  {
+    tb->AddTool(ID_CHILD_FIND, wxT("Find"), wxArtProvider::GetBitmap(wxART_FIND, wxART_TOOLBAR), wxT("Find values in variable."));
+    tb->AddTool(ID_CHILD_FIND_NEXT, wxT("Find next"), wxArtProvider::GetBitmap(wxART_GO_DOWN, wxART_TOOLBAR), 
+      wxT("Show next value found."));
+  }
+
+  //number of dimensions above a two-dimensional dataset (tool IDs are reserved for max_dimension)
+  for (size_t idx_dmn = 0; idx_dmn < m_grid->m_layer.size() && idx_dmn < static_cast<size_t>(max_dimension); idx_dmn++)
   {
+    int dim_layer = m_grid->m_grid_policy.m_dim_layers[idx_dmn];
     tb->AddTool(ID_CHILD_FORWARD + idx_dmn, wxT("Forward"), wxBitmap(forward_xpm), wxT("Move forward to next layer."));
     tb->AddTool(ID_CHILD_BACK + idx_dmn, wxT("Back"), wxBitmap(back_xpm), wxT("Return to previous layer."));
     wxArrayString vec_str;
 
-    //coordinate variable exists
-    if (item_data->m_ncvar_crd[idx_dmn] != NULL)
+    //coordinate variable exists (and was read)
+    if (item_data->m_ncvar_crd[dim_layer] != NULL && item_data->m_ncvar_crd[dim_layer]->m_buf != NULL)
     {
-      void *buf = item_data->m_ncvar_crd[idx_dmn]->m_buf;
-      size_t size = item_data->m_ncvar->m_ncdim[idx_dmn].m_size;
-      switch (item_data->m_ncvar_crd[idx_dmn]->m_nc_type)
+      ncvar_t *ncvar_crd = item_data->m_ncvar_crd[dim_layer];
+      ncarena_t arena;
+      arena.format(ncformat_t(ncvar_crd->m_nc_type), ncvar_crd->m_buf, 0, ncvar_crd->size());
+      for (size_t idx = 0; idx < arena.size(); idx++)
       {
-      case NC_FLOAT:
-        buf_float = static_cast<float*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_FLOAT), buf_float[idx]));
-        }
-        break;
-      case NC_DOUBLE:
-        buf_double = static_cast<double*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_DOUBLE), buf_double[idx]));
-        }
-        break;
-      case NC_INT:
-        buf_int = static_cast<int*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_INT), buf_int[idx]));
-        }
-        break;
-      case NC_SHORT:
-        buf_short = static_cast<short*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_SHORT), buf_short[idx]));
-        }
-        break;
-      case NC_BYTE:
-        buf_byte = static_cast<signed char*>  (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_BYTE), buf_byte[idx]));
-        }
-        break;
-      case NC_UBYTE:
-        buf_ubyte = static_cast<unsigned char*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_UBYTE), buf_ubyte[idx]));
-        }
-        break;
-      case NC_USHORT:
-        buf_ushort = static_cast<unsigned short*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_USHORT), buf_ushort[idx]));
-        }
-        break;
-      case NC_UINT:
-        buf_uint = static_cast<unsigned int*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_UINT), buf_uint[idx]));
-        }
-        break;
-      case NC_INT64:
-        buf_int64 = static_cast<long long*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_INT64), buf_int64[idx]));
-        }
-        break;
-      case NC_UINT64:
-        buf_uint64 = static_cast<unsigned long long*> (buf);
-        for (size_t idx = 0; idx < size; idx++)
-        {
-          vec_str.Add(wxString::Format(m_grid->GetFormat(NC_UINT64), buf_uint64[idx]));
-        }
-        break;
-      } //switch
+        vec_str.Add(wxString(arena.str(idx), arena.length(idx)));
+      }
     }
     else
     {
-      for (unsigned int idx = 0; idx < item_data->m_ncvar->m_ncdim[idx_dmn].m_size; idx++)
+      for (unsigned int idx = 0; idx < item_data->m_ncvar->m_ncdim[dim_layer].m_size; idx++)
       {
         vec_str.Add(wxString::Format("%u", idx + 1));
       }
@@ -602,8 +1550,8 @@ void wxFrameChild::OnChoiceLayer(wxCommandEvent& event)
     {
       wxChoice* choice_layer = (wxChoice*)GetToolBar()->FindControl(ID_CHILD_INDEX_LAYER + idx_dmn);
       m_grid->m_layer[idx_dmn] = choice_layer->GetSelection();
-      m_grid->ShowGrid();
-      m_grid->Refresh();
+      UpdateGrid();
+      m_grid->Prefetch(idx_dmn, 1);
     }
   }
 }
@@ -619,17 +1567,18 @@ void wxFrameChild::OnForward(wxCommandEvent& event)
   {
     if (event.GetId() == static_cast<int>(ID_CHILD_FORWARD + idx_dmn))
     {
+      size_t nbr_layer = m_grid->m_ncvar->m_ncdim[m_grid->m_grid_policy.m_dim_layers[idx_dmn]].m_size;
       m_grid->m_layer[idx_dmn]++;
-      if ((size_t)m_grid->m_layer[idx_dmn] >= m_grid->m_ncvar->m_ncdim[idx_dmn].m_size)
+      if ((size_t)m_grid->m_layer[idx_dmn] >= nbr_layer)
       {
-        m_grid->m_layer[idx_dmn] = m_grid->m_ncvar->m_ncdim[idx_dmn].m_size - 1;
+        m_grid->m_layer[idx_dmn] = nbr_layer - 1;
         return;
       }
       //update choice
       wxChoice* choice_layer = (wxChoice*)GetToolBar()->FindControl(ID_CHILD_INDEX_LAYER + idx_dmn);
       choice_layer->SetSelection(m_grid->m_layer[idx_dmn]);
-      m_grid->ShowGrid();
-      m_grid->Refresh();
+      UpdateGrid();
+      m_grid->Prefetch(idx_dmn, 1);
     }
   }
 }
@@ -654,1147 +1603,3950 @@ void wxFrameChild::OnBack(wxCommandEvent& event)
       //update choice
       wxChoice* choice_layer = (wxChoice*)GetToolBar()->FindControl(ID_CHILD_INDEX_LAYER + idx_dmn);
       choice_layer->SetSelection(m_grid->m_layer[idx_dmn]);
-      m_grid->ShowGrid();
-      m_grid->Refresh();
+      UpdateGrid();
+      m_grid->Prefetch(idx_dmn, -1);
     }
   }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameChild::OnActivate
+//wxFrameChild::OnStats
+//show or hide the statistics pane; statistics of the variable are computed in background when
+//first shown
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameChild::OnActivate(wxActivateEvent& event)
+const int stats_pane_height = 80; //pixels
+
+void wxFrameChild::OnStats(wxCommandEvent& event)
 {
-  if (event.GetActive() && m_grid)
-    m_grid->SetFocus();
+  if (!event.IsChecked())
+  {
+    m_splitter->Unsplit(m_stats);
+    return;
+  }
+  m_splitter->SplitHorizontally(m_grid, m_stats, -stats_pane_height);
+  if (m_thread_stats == NULL && !m_stats_var_done && nc_is_numeric(m_item_data->m_ncvar->m_nc_type))
+  {
+    m_thread_stats = new wxThreadStats(this, m_item_data);
+    if (m_thread_stats->Run() != wxTHREAD_NO_ERROR)
+    {
+      delete m_thread_stats;
+      m_thread_stats = NULL;
+    }
+  }
+  UpdateStats();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::wxFrameExplorer
+//wxFrameChild::OnStatsDone
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-wxBEGIN_EVENT_TABLE(wxFrameExplorer, wxMDIParentFrame)
-EVT_MENU(wxID_OPEN, wxFrameExplorer::OnFileOpen)
-EVT_MENU(ID_FRAME_OPENDAP, wxFrameExplorer::OnFileOpenDap)
-EVT_MENU(wxID_EXIT, wxFrameExplorer::OnQuit)
-EVT_MENU_RANGE(wxID_FILE1, wxID_FILE9, wxFrameExplorer::OnMRUFile)
-EVT_SIZE(wxFrameExplorer::OnSize)
-EVT_SASH_DRAGGED_RANGE(ID_WINDOW_SASH, ID_WINDOW_SASH, wxFrameExplorer::OnSashDrag)
-EVT_MENU(wxID_ABOUT, wxFrameExplorer::OnAbout)
-wxEND_EVENT_TABLE()
-
-wxFrameExplorer::wxFrameExplorer() : wxMDIParentFrame(NULL, wxID_ANY, GetAppName(), wxDefaultPosition, wxSize(550, 840))
+void wxFrameChild::OnStatsDone(wxThreadEvent& WXUNUSED(event))
 {
-  int w, h;
-  GetClientSize(&w, &h);
-
-  SetIcon(wxICON(sample));
-  wxMenu *menu_file = new wxMenu;
-  menu_file->Append(wxID_OPEN, _("&Open...\tCtrl+O"));
-  menu_file->Append(ID_FRAME_OPENDAP, wxT("OPeN&DAP...\tCtrl+D"));
-  menu_file->AppendSeparator();
-  menu_file->Append(wxID_EXIT, "E&xit\tAlt-X", "Quit");
-  wxMenu *menu_help = new wxMenu;
-  menu_help->Append(wxID_ABOUT, "&About\tF1", "Show about dialog");
-  wxMenuBar *menu_bar = new wxMenuBar();
-  menu_bar->Append(menu_file, "&File");
-  menu_bar->Append(menu_help, "&Help");
-  SetMenuBar(menu_bar);
-  m_file_history.UseMenu(menu_file);
-  m_file_history.AddFilesToMenu(menu_file);
-  m_file_history.Load(*wxConfig::Get());
-  CreateStatusBar(1);
-
-  wxSashLayoutWindow* win;
-  win = new wxSashLayoutWindow(this, ID_WINDOW_SASH, wxDefaultPosition, wxDefaultSize, wxNO_BORDER | wxSW_3D | wxCLIP_CHILDREN);
-  win->SetDefaultSize(wxSize(300, h));
-  win->SetOrientation(wxLAYOUT_VERTICAL);
-  win->SetAlignment(wxLAYOUT_LEFT);
-  win->SetSashVisible(wxSASH_RIGHT, true);
-  win->SetExtraBorderSize(10);
-  win->SetMinimumSizeX(100);
-  win->SetBackgroundColour(*wxWHITE);
-  m_sash = win;
-
-  m_tree = new wxTreeCtrlExplorer(m_sash, wxID_ANY, wxPoint(0, 0), wxSize(160, 250), wxTR_DEFAULT_STYLE | wxNO_BORDER | wxTR_HIDE_ROOT);
-  wxImageList* imglist = new wxImageList(16, 16, true, 2);
-  wxBitmap bitmaps[3];
-  bitmaps[id_folder] = wxBitmap(wxArtProvider::GetBitmap(wxART_FOLDER, wxART_OTHER, wxSize(16, 16)));
-  bitmaps[id_variable] = wxBitmap(wxArtProvider::GetBitmap(wxART_NORMAL_FILE, wxART_OTHER, wxSize(16, 16)));
-  bitmaps[id_attribute] = wxBitmap(doc_blue_xpm);
-  imglist->Add(bitmaps[id_folder]);
-  imglist->Add(bitmaps[id_variable]);
-  imglist->Add(bitmaps[id_attribute]);
-  m_tree->AssignImageList(imglist);
-  m_tree_root = m_tree->AddRoot("");
+  if (m_thread_stats == NULL)
+  {
+    return;
+  }
+  m_thread_stats->Wait();
+  m_stats_var = m_thread_stats->m_stats;
+  m_stats_var_done = (m_thread_stats->m_load->m_status == NC_NOERR);
+  delete m_thread_stats;
+  m_thread_stats = NULL;
+  //colors of the image are the same for all layers
+  if (m_image != NULL && m_stats_var_done && m_stats_var.m_nbr > 0)
+  {
+    m_image->SetRange(m_stats_var.m_min, m_stats_var.m_max);
+  }
+  UpdateStats();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::~wxFrameExplorer
+//wxFrameChild::OnImage
+//show the image or the grid (the grid stays available to inspect values)
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-wxFrameExplorer::~wxFrameExplorer()
+void wxFrameChild::OnImage(wxCommandEvent& event)
 {
-  m_file_history.Save(*wxConfig::Get());
+  wxWindow *window_show = event.IsChecked() ? static_cast<wxWindow*>(m_image) : static_cast<wxWindow*>(m_grid);
+  wxWindow *window_hide = event.IsChecked() ? static_cast<wxWindow*>(m_grid) : static_cast<wxWindow*>(m_image);
+  m_splitter->ReplaceWindow(window_hide, window_show);
+  window_hide->Hide();
+  window_show->Show();
+  if (event.IsChecked())
+  {
+    m_image->Render();
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnQuit
+//wxFrameChild::OnChoiceImageMode
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnQuit(wxCommandEvent& WXUNUSED(event))
+void wxFrameChild::OnChoiceImageMode(wxCommandEvent& event)
 {
-  m_file_history.Save(*wxConfig::Get());
-  Close(true);
+  m_image->SetMode(event.GetSelection());
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnMRUFile
+//wxFrameChild::ShowCell
+//show the grid at a cell of the current layer
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnMRUFile(wxCommandEvent& event)
+void wxFrameChild::ShowCell(int row, int col)
 {
-  wxString path(m_file_history.GetHistoryFile(event.GetId() - wxID_FILE1));
-  if (!path.empty())
+  if (m_image != NULL && m_image->IsShown())
   {
-    OpenFile(path);
+    GetToolBar()->ToggleTool(ID_CHILD_IMAGE, false);
+    m_splitter->ReplaceWindow(m_image, m_grid);
+    m_image->Hide();
+    m_grid->Show();
   }
+  m_grid->SetGridCursor(row, col);
+  m_grid->MakeCellVisible(row, col);
+  m_grid->SetFocus();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnFileOpen
+//wxFrameChild::ShowIndex
+//show the grid at an element of the variable (index in variable), stepping to its layer
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnFileOpen(wxCommandEvent &WXUNUSED(event))
+void wxFrameChild::ShowIndex(size_t idx_var)
 {
-  wxString path;
-  wxFileDialog dlg(this, wxT("Open file"),
-    wxEmptyString,
-    wxEmptyString,
-    wxString::Format
-    (
-      wxT("netCDF (*.nc)|*.nc|All files (%s)|%s"),
-      wxFileSelectorDefaultWildcardStr,
-      wxFileSelectorDefaultWildcardStr
-    ),
-    wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_CHANGE_DIR);
-  if (dlg.ShowModal() != wxID_OK) return;
-  path = dlg.GetPath();
-  if (this->OpenFile(path) != NC_NOERR)
+  const std::vector<ncdim_t> &ncdim = m_item_data->m_ncvar->m_ncdim;
+  const grid_policy_t &grid_policy = m_grid->m_grid_policy;
+  std::vector<size_t> idx(ncdim.size(), 0);
+  for (size_t idx_dmn = ncdim.size(); idx_dmn-- > 0 && ncdim[idx_dmn].m_size > 0;)
+  {
+    idx[idx_dmn] = idx_var % ncdim[idx_dmn].m_size;
+    idx_var /= ncdim[idx_dmn].m_size;
+  }
+  bool is_layer = false;
+  for (size_t idx_dmn = 0; idx_dmn < m_grid->m_layer.size(); idx_dmn++)
   {
+    int idx_layer = static_cast<int>(idx[grid_policy.m_dim_layers[idx_dmn]]);
+    if (m_grid->m_layer[idx_dmn] != idx_layer)
+    {
+      m_grid->m_layer[idx_dmn] = idx_layer;
+      wxChoice* choice_layer = (wxChoice*)GetToolBar()->FindControl(ID_CHILD_INDEX_LAYER + idx_dmn);
+      if (choice_layer != NULL)
+      {
+        choice_layer->SetSelection(idx_layer);
+      }
+      is_layer = true;
+    }
+  }
+  if (is_layer)
+  {
+    UpdateGrid();
+  }
+  ShowCell(grid_policy.m_dim_rows >= 0 ? static_cast<int>(idx[grid_policy.m_dim_rows]) : 0,
+    grid_policy.m_dim_cols >= 0 ? static_cast<int>(idx[grid_policy.m_dim_cols]) : 0);
 
+  wxString str;
+  for (size_t idx_dmn = 0; idx_dmn < idx.size(); idx_dmn++)
+  {
+    str += wxString::Format(wxT("%s%s=%lu"), idx_dmn ? wxT(", ") : wxT(""), ncdim[idx_dmn].m_name,
+      static_cast<unsigned long>(idx[idx_dmn] + 1));
   }
-  m_file_history.AddFileToHistory(path);
+  wxFrameExplorer *frame = (wxFrameExplorer*)GetParent();
+  frame->SetStatusText(wxString::Format(wxT("%s: found %lu of %lu%s (%s)"), m_item_data->m_item_nm,
+    static_cast<unsigned long>(m_find_idx + 1), static_cast<unsigned long>(m_find_hits.size()),
+    (m_find_hits.size() >= max_find_hits) ? wxT(" (first)") : wxT(""), str));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnFileOpenDap
+//wxFrameChild::OnFind
+//search values in the whole variable in background; the first one found is shown when done
+//the condition is the last one entered, or the maximum of the variable if its statistics are known
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnFileOpenDap(wxCommandEvent& WXUNUSED(event))
+void wxFrameChild::OnFind(wxCommandEvent& WXUNUSED(event))
 {
-  wxTextEntryDialog dialog(this, wxT("OPeNDAP URL:"), wxT("OPeNDAP"));
-  if (dialog.ShowModal() == wxID_OK)
+  if (m_thread_find != NULL)
   {
-    wxString path = dialog.GetValue();
-    if (this->OpenFile(path) != NC_NOERR)
-    {
-
-    }
-    m_file_history.AddFileToHistory(path);
+    return;
+  }
+  if (!m_find_done && m_stats_var_done && m_stats_var.m_nbr > 0)
+  {
+    m_find = ncfind_t(nc_find_equal, m_stats_var.m_max);
+  }
+  wxDialogFind dialog(this, m_item_data->m_ncvar, m_find);
+  if (dialog.ShowModal() != wxID_OK || !dialog.GetFind(m_find))
+  {
+    return;
   }
+  m_find_done = true;
+  m_find_hits.clear();
+  m_find_idx = 0;
+  m_thread_find = new wxThreadFind(this, m_item_data, m_find);
+  if (m_thread_find->Run() != wxTHREAD_NO_ERROR)
+  {
+    delete m_thread_find;
+    m_thread_find = NULL;
+    return;
+  }
+  wxFrameExplorer *frame = (wxFrameExplorer*)GetParent();
+  frame->SetStatusText(wxString::Format(wxT("%s: finding..."), m_item_data->m_item_nm));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnSashDrag
+//wxFrameChild::OnFindDone
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnSashDrag(wxSashEvent& event)
+void wxFrameChild::OnFindDone(wxThreadEvent& WXUNUSED(event))
 {
-  int w, h;
-  GetClientSize(&w, &h);
-
-  if (event.GetDragStatus() == wxSASH_STATUS_OUT_OF_RANGE)
+  if (m_thread_find == NULL)
+  {
     return;
-
-  switch (event.GetId())
+  }
+  m_thread_find->Wait();
+  int status = m_thread_find->m_load->m_status;
+  m_find_hits.swap(m_thread_find->m_hits);
+  delete m_thread_find;
+  m_thread_find = NULL;
+  wxFrameExplorer *frame = (wxFrameExplorer*)GetParent();
+  if (status != NC_NOERR)
   {
-  case ID_WINDOW_SASH:
-    m_sash->SetDefaultSize(wxSize(event.GetDragRect().width, h));
-    break;
+    frame->SetStatusText(wxString::Format(wxT("%s: find read error"), m_item_data->m_item_nm));
+  }
+  else if (m_find_hits.empty())
+  {
+    frame->SetStatusText(wxString::Format(wxT("%s: not found"), m_item_data->m_item_nm));
+  }
+  else
+  {
+    ShowIndex(m_find_hits[m_find_idx]);
   }
-
-  wxLayoutAlgorithm layout;
-  layout.LayoutMDIFrame(this);
-  GetClientWindow()->Refresh();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnSize
+//wxFrameChild::OnFindNext
+//show the next value found (the first after the last)
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnSize(wxSizeEvent& WXUNUSED(event))
+void wxFrameChild::OnFindNext(wxCommandEvent& WXUNUSED(event))
 {
-  wxLayoutAlgorithm layout;
-  layout.LayoutMDIFrame(this);
+  if (m_find_hits.empty())
+  {
+    return;
+  }
+  m_find_idx = (m_find_idx + 1) % m_find_hits.size();
+  ShowIndex(m_find_hits[m_find_idx]);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OpenFile
+//wxFrameChild::OnUpdateFind
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int wxFrameExplorer::OpenFile(const wxString& file_name)
+void wxFrameChild::OnUpdateFind(wxUpdateUIEvent& event)
 {
-  int nc_id;
-
-  if (nc_open(file_name, NC_NOWRITE, &nc_id) != NC_NOERR)
-  {
-    return -1;
-  }
-
-  //root item
-  wxItemData *item_data = new wxItemData(wxItemData::Root,
-    file_name,
-    file_name,
-    wxString("/"),
-    (wxItemData*)NULL,
-    (ncvar_t*)NULL,
-    (grid_policy_t*)NULL);
+  event.Enable(m_thread_find == NULL);
+}
 
-  //last component of full path file name used for root tree only
-  wxTreeItemId root = m_tree->AppendItem(m_tree_root, GetPathComponent(file_name), 0, 0, item_data);
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameChild::OnUpdateFindNext
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (Iterate(file_name, nc_id, root) != NC_NOERR)
-  {
+void wxFrameChild::OnUpdateFindNext(wxUpdateUIEvent& event)
+{
+  event.Enable(m_find_hits.size() > 1);
+}
 
-  }
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//FormatStats
+//one line of the statistics pane (and of the batch mode)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (nc_close(nc_id) != NC_NOERR)
+wxString FormatStats(const wxString &label, const ncstats_t &stats)
+{
+  if (stats.m_nbr == 0)
   {
-
+    return wxString::Format(wxT("%-9s %15s %15s %15s %15s %12lu %12lu %12lu\n"), label, wxT("-"), wxT("-"), wxT("-"), wxT("-"),
+      static_cast<unsigned long>(stats.m_nbr_nan), static_cast<unsigned long>(stats.m_nbr_fill), 0UL);
   }
+  return wxString::Format(wxT("%-9s %15.8g %15.8g %15.8g %15.8g %12lu %12lu %12lu\n"), label, 
+    stats.m_min, stats.m_max, stats.m_mean, stats.stddev(),
+    static_cast<unsigned long>(stats.m_nbr_nan), static_cast<unsigned long>(stats.m_nbr_fill), static_cast<unsigned long>(stats.m_nbr));
+}
 
-  return NC_NOERR;
+wxString FormatStatsHeader()
+{
+  return wxString::Format(wxT("%-9s %15s %15s %15s %15s %12s %12s %12s\n"), wxT(""), 
+    wxT("min"), wxT("max"), wxT("mean"), wxT("stddev"), wxT("NaN"), wxT("_FillValue"), wxT("valid"));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::Iterate
+//wxFrameChild::UpdateStats
+//statistics of the current layer (computed on each step, the layer is resident) and of the variable
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int wxFrameExplorer::Iterate(const wxString& file_name, const int grp_id, wxTreeItemId item_id)
+void wxFrameChild::UpdateStats()
 {
-  char grp_nm[NC_MAX_NAME + 1]; // group name 
-  char var_nm[NC_MAX_NAME + 1]; // variable name 
-  char *grp_nm_fll = NULL; // group full name 
-  int nbr_att; // number of attributes 
-  int nbr_dmn_grp; // number of dimensions for group 
-  int nbr_var; // number of variables 
-  int nbr_grp; // number of sub-groups in this group 
-  int nbr_dmn_var; // number of dimensions for variable 
-  nc_type var_typ; // netCDF type 
-  int *grp_ids; // sub-group IDs array
-  size_t grp_nm_lng; //lenght of full group name
-  int var_dimid[NC_MAX_VAR_DIMS]; // dimensions for variable
-  size_t dmn_sz[NC_MAX_VAR_DIMS]; // dimensions for variable sizes
-  char dmn_nm_var[NC_MAX_NAME + 1]; //dimension name
-
-  //get item data (of parent item), to store a list of variable names 
-  wxItemData *item_data_prn = (wxItemData *)m_tree->GetItemData(item_id);
-  assert(item_data_prn->m_kind == wxItemData::Group || item_data_prn->m_kind == wxItemData::Root);
-
-  // get full name of (parent) group
-  if (nc_inq_grpname_full(grp_id, &grp_nm_lng, NULL) != NC_NOERR)
+  if (!m_splitter->IsSplit())
   {
-
+    return;
   }
-
-  grp_nm_fll = new char[grp_nm_lng + 1];
-
-  if (nc_inq_grpname_full(grp_id, &grp_nm_lng, grp_nm_fll) != NC_NOERR)
+  const ncvar_t *ncvar = m_item_data->m_ncvar;
+  if (!nc_is_numeric(ncvar->m_nc_type))
   {
-
+    m_stats->SetValue(wxT("no statistics for text variables"));
+    return;
   }
-
-  if (nc_inq(grp_id, &nbr_dmn_grp, &nbr_var, &nbr_att, (int *)NULL) != NC_NOERR)
+  wxString str = FormatStatsHeader();
+  size_t idx_buf;
+  size_t nbr;
+  ncvar_t *ncvar_layer = m_grid->m_layer.empty() ? NULL : m_grid->GetLayer(idx_buf, nbr);
+  if (ncvar_layer != NULL && ncvar_layer->m_buf != NULL)
   {
-
+    ncstats_t stats;
+    nc_stats_parallel(ncvar_layer->m_nc_type, static_cast<const char*>(ncvar_layer->m_buf) + idx_buf * ncvar_layer->type_size(), nbr,
+      ncvar_layer->m_fill, stats);
+    str += FormatStats(wxT("layer"), stats);
   }
-
-  for (int idx_var = 0; idx_var < nbr_var; idx_var++)
+  if (m_stats_var_done)
   {
-    std::vector<ncdim_t> ncdim; //dimensions for each variable 
-
-    if (nc_inq_var(grp_id, idx_var, var_nm, &var_typ, &nbr_dmn_var, var_dimid, &nbr_att) != NC_NOERR)
-    {
-
-    }
-
-    //store variable name in parent group item (for coordinate variables detection)
-    item_data_prn->m_var_nms.push_back(var_nm);
+    str += FormatStats(wxT("variable"), m_stats_var);
+  }
+  else
+  {
+    str += (m_thread_stats != NULL) ? wxT("variable  computing...\n") : wxT("variable  read error\n");
+  }
+  m_stats->SetValue(str);
+}
 
-    //get dimensions
-    for (int idx_dmn = 0; idx_dmn < nbr_dmn_var; idx_dmn++)
-    {
-      //dimensions belong to groups
-      if (nc_inq_dim(grp_id, var_dimid[idx_dmn], dmn_nm_var, &dmn_sz[idx_dmn]) != NC_NOERR)
-      {
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameChild::OnActivate
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-      }
+void wxFrameChild::OnActivate(wxActivateEvent& event)
+{
+  if (event.GetActive() && m_grid)
+    m_grid->SetFocus();
+}
 
-      //store dimension 
-      ncdim_t dim(dmn_nm_var, dmn_sz[idx_dmn]);
-      ncdim.push_back(dim);
-    }
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::wxImageLayers
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    //store a ncvar_t
-    ncvar_t *ncvar = new ncvar_t(var_nm, var_typ, ncdim);
+wxBEGIN_EVENT_TABLE(wxImageLayers, wxWindow)
+EVT_PAINT(wxImageLayers::OnPaint)
+EVT_SIZE(wxImageLayers::OnSize)
+EVT_LEFT_DCLICK(wxImageLayers::OnLeftDClick)
+EVT_LEFT_DOWN(wxImageLayers::OnLeftDown)
+EVT_MOTION(wxImageLayers::OnMotion)
+EVT_MOUSEWHEEL(wxImageLayers::OnMouseWheel)
+EVT_RIGHT_DOWN(wxImageLayers::OnRightDown)
+wxEND_EVENT_TABLE()
 
-    //define a grid dimensions policy
-    grid_policy_t *grid_policy = new grid_policy_t(ncdim);
+wxImageLayers::wxImageLayers(wxWindow *parent, wxGridLayers *grid) :
+  wxWindow(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE),
+  m_grid(grid),
+  m_range_var(false),
+  m_min(0),
+  m_max(0),
+  m_mode(nc_level_mean),
+  m_fit(true),
+  m_view(0, 0, 1, 1)
+{
+  SetBackgroundStyle(wxBG_STYLE_PAINT);
+}
 
-    //append item
-    wxItemData *item_data_var = new wxItemData(wxItemData::Variable,
-      file_name,
-      grp_nm_fll,
-      var_nm,
-      item_data_prn,
-      ncvar,
-      grid_policy);
-    m_tree->AppendItem(item_id, var_nm, 1, 1, item_data_var);
-  }
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::~wxImageLayers
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (nc_inq_grps(grp_id, &nbr_grp, (int *)NULL) != NC_NOERR)
+wxImageLayers::~wxImageLayers()
+{
+  for (size_t idx = 0; idx < m_layer_image.size(); idx++)
   {
-
+    delete m_layer_image[idx];
   }
+}
 
-  grp_ids = new int[nbr_grp];
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::GetLayerImage
+//pyramid and statistics of the current layer, created (evicting the least recently shown layer) if
+//the layer was not shown recently
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (nc_inq_grps(grp_id, &nbr_grp, grp_ids) != NC_NOERR)
+nclayer_image_t* wxImageLayers::GetLayerImage(const ncvar_t *ncvar_layer, size_t nbr_rows, size_t nbr_cols)
+{
+  nclayer_image_t *layer_image = NULL;
+  for (size_t idx = 0; idx < m_layer_image.size(); idx++)
   {
-
+    if (m_layer_image[idx]->m_layer == m_grid->m_layer)
+    {
+      layer_image = m_layer_image[idx];
+      m_layer_image.erase(m_layer_image.begin() + idx);
+      break;
+    }
   }
-
-  for (int idx_grp = 0; idx_grp < nbr_grp; idx_grp++)
+  if (layer_image == NULL)
   {
-    if (nc_inq_grpname(grp_ids[idx_grp], grp_nm) != NC_NOERR)
+    if (m_layer_image.size() >= max_image_layers)
     {
-
+      delete m_layer_image.front();
+      m_layer_image.erase(m_layer_image.begin());
     }
+    layer_image = new nclayer_image_t(m_grid->m_layer, ncvar_layer->m_nc_type, nbr_rows, nbr_cols, ncvar_layer->m_fill);
+  }
+  m_layer_image.push_back(layer_image);
+  return layer_image;
+}
 
-    //group item
-    wxItemData *item_data_grp = new wxItemData(wxItemData::Group,
-      file_name,
-      grp_nm_fll,
-      grp_nm,
-      item_data_prn,
-      (ncvar_t*)NULL,
-      (grid_policy_t*)NULL);
-    wxTreeItemId item_id_grp = m_tree->AppendItem(item_id, grp_nm, 0, 0, item_data_grp);
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::Render
+//render the view of the current layer to the size of the window, from the layer when elements are 
+//not smaller than half a pixel, otherwise from the pyramid level whose blocks are not smaller than a 
+//pixel (built on first use); colors span the range of the layer until the range of the variable is 
+//known
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    if (Iterate(file_name, grp_ids[idx_grp], item_id_grp) != NC_NOERR)
+void wxImageLayers::Render()
+{
+  int width;
+  int height;
+  size_t idx_buf;
+  size_t nbr;
+  GetClientSize(&width, &height);
+  const ncvar_t *ncvar_layer = m_grid->GetLayer(idx_buf, nbr);
+  if (width <= 0 || height <= 0 || nbr == 0 || ncvar_layer == NULL || ncvar_layer->m_buf == NULL)
+  {
+    m_bitmap = wxBitmap();
+    Refresh(false);
+    return;
+  }
+  const void *buf = static_cast<const char*>(ncvar_layer->m_buf) + idx_buf * ncvar_layer->type_size();
+  size_t nbr_rows = m_grid->GetNumberRows();
+  size_t nbr_cols = m_grid->GetNumberCols();
+  nclayer_image_t *layer_image = GetLayerImage(ncvar_layer, nbr_rows, nbr_cols);
+  double val_min = m_min;
+  double val_max = m_max;
+  if (!m_range_var)
+  {
+    if (!layer_image->m_stats_done)
     {
-
+      nc_stats_parallel(ncvar_layer->m_nc_type, buf, nbr, ncvar_layer->m_fill, layer_image->m_stats);
+      layer_image->m_stats_done = true;
     }
+    val_min = layer_image->m_stats.m_min;
+    val_max = layer_image->m_stats.m_max;
   }
-
-  delete[] grp_ids;
-  delete[] grp_nm_fll;
-
-  return NC_NOERR;
+  if (m_fit)
+  {
+    m_view = ncview_t(nbr_rows, nbr_cols, width, height);
+  }
+  ncview_t view = m_view;
+  size_t idx_level = layer_image->m_pyramid.select(std::max(m_view.m_row_scale, m_view.m_col_scale));
+  if (idx_level > 0)
+  {
+    const nclevel_t *level = layer_image->m_pyramid.level(idx_level, buf);
+    buf = &level->m_buf[m_mode][0];
+    nbr_rows = level->m_nbr_rows;
+    nbr_cols = level->m_nbr_cols;
+    view = m_view.level(level->m_block);
+  }
+  m_rgb.resize(static_cast<size_t>(width) * height * 3);
+  nc_render_parallel(ncvar_layer->m_nc_type, buf, nbr_rows, nbr_cols, ncvar_layer->m_fill,
+    val_min, val_max, m_colormap, view, width, height, &m_rgb[0]);
+  m_bitmap = wxBitmap(wxImage(width, height, &m_rgb[0], true));
+  Refresh(false);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxFrameExplorer::OnAbout
+//wxImageLayers::SetRange
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxFrameExplorer::OnAbout(wxCommandEvent& WXUNUSED(event))
+void wxImageLayers::SetRange(double val_min, double val_max)
 {
-  wxMessageBox("(c) 2015 Pedro Vicente -- Space Research Software LLC\n\n", GetAppName(), wxOK, this);
+  m_range_var = true;
+  m_min = val_min;
+  m_max = val_max;
+  if (IsShown())
+  {
+    Render();
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::wxTreeCtrlExplorer
+//wxImageLayers::SetMode
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-wxBEGIN_EVENT_TABLE(wxTreeCtrlExplorer, wxTreeCtrl)
-EVT_TREE_SEL_CHANGED(wxID_ANY, wxTreeCtrlExplorer::OnSelChanged)
-EVT_TREE_ITEM_ACTIVATED(wxID_ANY, wxTreeCtrlExplorer::OnItemActivated)
-EVT_TREE_ITEM_MENU(wxID_ANY, wxTreeCtrlExplorer::OnItemMenu)
-EVT_MENU(ID_TREE_LOAD_ITEM, wxTreeCtrlExplorer::OnLoadItem)
-wxEND_EVENT_TABLE()
-
-wxTreeCtrlExplorer::wxTreeCtrlExplorer(wxWindow *parent, const wxWindowID id, const wxPoint& pos, const wxSize& size, long style)
-  : wxTreeCtrl(parent, id, pos, size, style)
+void wxImageLayers::SetMode(int mode)
 {
-
+  m_mode = mode;
+  if (IsShown())
+  {
+    Render();
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::~wxTreeCtrlExplorer
+//wxImageLayers::OnPaint
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-wxTreeCtrlExplorer::~wxTreeCtrlExplorer()
+void wxImageLayers::OnPaint(wxPaintEvent& WXUNUSED(event))
 {
-
+  wxPaintDC dc(this);
+  if (m_bitmap.IsOk())
+  {
+    dc.DrawBitmap(m_bitmap, 0, 0);
+  }
+  else
+  {
+    dc.Clear();
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::ShowVariable
+//wxImageLayers::OnSize
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxTreeCtrlExplorer::ShowVariable(wxItemData *item_data)
+void wxImageLayers::OnSize(wxSizeEvent& event)
 {
-  //if not loaded, read buffer from file 
-  if (item_data->m_ncvar->m_buf == NULL)
+  if (IsShown())
   {
-    LoadItem(item_data);
+    Render();
   }
-
-  //show in grid
-  wxSashLayoutWindow *sash = (wxSashLayoutWindow*)GetParent();
-  wxFrameExplorer *frame = (wxFrameExplorer*)sash->GetParent();
-  wxFrameChild *subframe = new wxFrameChild(frame,
-    wxString::Format(wxT("%s : %s"), GetPathComponent(item_data->m_file_name), item_data->m_item_nm),
-    item_data);
-  subframe->Show(true);
+  event.Skip();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::OnSelChanged
+//wxImageLayers::OnLeftDClick
+//inspect the values around the element under the mouse in the grid
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxTreeCtrlExplorer::OnSelChanged(wxTreeEvent& event)
+void wxImageLayers::OnLeftDClick(wxMouseEvent& event)
 {
-  event.Skip();
-#ifdef _DEBUG
-  wxTreeItemId item_id = event.GetItem();
-  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
-  if (item_data->m_kind != wxItemData::Variable)
+  double row = floor(m_view.m_row0 + event.GetY() * m_view.m_row_scale);
+  double col = floor(m_view.m_col0 + event.GetX() * m_view.m_col_scale);
+  if (row < 0 || row >= m_grid->GetNumberRows() || col < 0 || col >= m_grid->GetNumberCols())
   {
     return;
   }
-  ShowVariable(item_data);
-#endif
+  wxFrameChild *frame = (wxFrameChild*)GetParent()->GetParent();
+  frame->ShowCell(static_cast<int>(row), static_cast<int>(col));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::OnItemActivated
+//wxImageLayers::OnLeftDown
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxTreeCtrlExplorer::OnItemActivated(wxTreeEvent& event)
+void wxImageLayers::OnLeftDown(wxMouseEvent& event)
 {
-  wxTreeItemId item_id = event.GetItem();
-  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
+  m_drag = event.GetPosition();
+  SetFocus();
   event.Skip();
-  if (item_data->m_kind != wxItemData::Variable)
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::OnMotion
+//pan while dragging
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxImageLayers::OnMotion(wxMouseEvent& event)
+{
+  if (!event.Dragging() || !event.LeftIsDown())
   {
     return;
   }
-  ShowVariable(item_data);
+  wxPoint pos = event.GetPosition();
+  m_view.m_row0 -= (pos.y - m_drag.y) * m_view.m_row_scale;
+  m_view.m_col0 -= (pos.x - m_drag.x) * m_view.m_col_scale;
+  m_drag = pos;
+  m_fit = false;
+  Render();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::LoadItem
+//wxImageLayers::OnMouseWheel
+//zoom around the element under the mouse, by image_zoom_step each notch; zooming out past the whole
+//layer shows the whole layer
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxTreeCtrlExplorer::LoadItem(wxItemData *item_data)
+const double image_zoom_step = 1.25;
+const double image_zoom_max = 64; //pixels per element
+
+void wxImageLayers::OnMouseWheel(wxMouseEvent& event)
+{
+  int width;
+  int height;
+  GetClientSize(&width, &height);
+  if (width <= 0 || height <= 0 || event.GetWheelRotation() == 0)
+  {
+    return;
+  }
+  double zoom = (event.GetWheelRotation() > 0) ? image_zoom_step : 1 / image_zoom_step;
+  ncview_t view_fit(m_grid->GetNumberRows(), m_grid->GetNumberCols(), width, height);
+  double row_scale = std::max(m_view.m_row_scale / zoom, 1 / image_zoom_max);
+  double col_scale = std::max(m_view.m_col_scale / zoom, 1 / image_zoom_max);
+  if (row_scale >= view_fit.m_row_scale && col_scale >= view_fit.m_col_scale)
+  {
+    m_fit = true;
+  }
+  else
+  {
+    m_view.m_row0 += event.GetY() * (m_view.m_row_scale - row_scale);
+    m_view.m_col0 += event.GetX() * (m_view.m_col_scale - col_scale);
+    m_view.m_row_scale = row_scale;
+    m_view.m_col_scale = col_scale;
+    m_fit = false;
+  }
+  Render();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::OnRightDown
+//show the whole layer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxImageLayers::OnRightDown(wxMouseEvent& WXUNUSED(event))
+{
+  m_fit = true;
+  Render();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxImageLayers::GetToolBitmap
+//the colormap, as icon of the image tool
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxBitmap wxImageLayers::GetToolBitmap()
+{
+  const int size = 16;
+  nccolormap_t colormap;
+  wxImage image(size, size);
+  for (int x = 0; x < size; x++)
+  {
+    const unsigned char *color = colormap.m_rgb + (1 + x * (nc_colormap_size - 2) / (size - 1)) * 3;
+    for (int y = 0; y < size; y++)
+    {
+      image.SetRGB(x, y, color[0], color[1], color[2]);
+    }
+  }
+  return wxBitmap(image);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::wxFrameExplorer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxBEGIN_EVENT_TABLE(wxFrameExplorer, wxMDIParentFrame)
+EVT_MENU(wxID_OPEN, wxFrameExplorer::OnFileOpen)
+EVT_MENU(ID_FRAME_OPENDAP, wxFrameExplorer::OnFileOpenDap)
+EVT_MENU(wxID_EXIT, wxFrameExplorer::OnQuit)
+EVT_MENU_RANGE(wxID_FILE1, wxID_FILE9, wxFrameExplorer::OnMRUFile)
+EVT_SIZE(wxFrameExplorer::OnSize)
+EVT_SASH_DRAGGED_RANGE(ID_WINDOW_SASH, ID_WINDOW_SASH, wxFrameExplorer::OnSashDrag)
+EVT_MENU(wxID_ABOUT, wxFrameExplorer::OnAbout)
+EVT_TIMER(ID_TIMER_POOL, wxFrameExplorer::OnTimerPool)
+EVT_MENU(ID_FRAME_CANCEL_LOAD, wxFrameExplorer::OnCancelLoad)
+EVT_THREAD(ID_LOAD_PROGRESS, wxFrameExplorer::OnLoadProgress)
+EVT_THREAD(ID_LOAD_DONE, wxFrameExplorer::OnLoadDone)
+EVT_THREAD(ID_OPEN_DONE, wxFrameExplorer::OnOpenDone)
+wxEND_EVENT_TABLE()
+
+wxFrameExplorer::wxFrameExplorer() : wxMDIParentFrame(NULL, wxID_ANY, GetAppName(), wxDefaultPosition, wxSize(550, 840))
+{
+  int w, h;
+  GetClientSize(&w, &h);
+
+  SetIcon(wxICON(sample));
+  wxMenu *menu_file = new wxMenu;
+  menu_file->Append(wxID_OPEN, _("&Open...\tCtrl+O"));
+  menu_file->Append(ID_FRAME_OPENDAP, wxT("OPeN&DAP...\tCtrl+D"));
+  menu_file->Append(ID_FRAME_CANCEL_LOAD, wxT("&Cancel Loading\tCtrl+K"), "Cancel variables being read");
+  menu_file->AppendSeparator();
+  menu_file->Append(wxID_EXIT, "E&xit\tAlt-X", "Quit");
+  wxMenu *menu_help = new wxMenu;
+  menu_help->Append(wxID_ABOUT, "&About\tF1", "Show about dialog");
+  wxMenuBar *menu_bar = new wxMenuBar();
+  menu_bar->Append(menu_file, "&File");
+  menu_bar->Append(menu_help, "&Help");
+  SetMenuBar(menu_bar);
+  m_file_history.UseMenu(menu_file);
+  m_file_history.AddFilesToMenu(menu_file);
+  m_file_history.Load(*wxConfig::Get());
+  CreateStatusBar(1);
+
+  wxSashLayoutWindow* win;
+  win = new wxSashLayoutWindow(this, ID_WINDOW_SASH, wxDefaultPosition, wxDefaultSize, wxNO_BORDER | wxSW_3D | wxCLIP_CHILDREN);
+  win->SetDefaultSize(wxSize(300, h));
+  win->SetOrientation(wxLAYOUT_VERTICAL);
+  win->SetAlignment(wxLAYOUT_LEFT);
+  win->SetSashVisible(wxSASH_RIGHT, true);
+  win->SetExtraBorderSize(10);
+  win->SetMinimumSizeX(100);
+  win->SetBackgroundColour(*wxWHITE);
+  m_sash = win;
+
+  m_tree = new wxTreeCtrlExplorer(m_sash, wxID_ANY, wxPoint(0, 0), wxSize(160, 250), wxTR_DEFAULT_STYLE | wxNO_BORDER | wxTR_HIDE_ROOT);
+  wxImageList* imglist = new wxImageList(16, 16, true, 2);
+  wxBitmap bitmaps[3];
+  bitmaps[id_folder] = wxBitmap(wxArtProvider::GetBitmap(wxART_FOLDER, wxART_OTHER, wxSize(16, 16)));
+  bitmaps[id_variable] = wxBitmap(wxArtProvider::GetBitmap(wxART_NORMAL_FILE, wxART_OTHER, wxSize(16, 16)));
+  bitmaps[id_attribute] = wxBitmap(doc_blue_xpm);
+  imglist->Add(bitmaps[id_folder]);
+  imglist->Add(bitmaps[id_variable]);
+  imglist->Add(bitmaps[id_attribute]);
+  m_tree->AssignImageList(imglist);
+  m_tree_root = m_tree->AddRoot("");
+
+  m_timer_pool.SetOwner(this, ID_TIMER_POOL);
+  m_timer_pool.Start(30 * 1000);
+
+  m_thread_load = new wxThreadLoad(this);
+  m_thread_load->Run();
+
+  m_thread_open = new wxThreadOpen(this, &m_queue_open);
+  m_thread_open->Run();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::~wxFrameExplorer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxFrameExplorer::~wxFrameExplorer()
+{
+  m_file_history.Save(*wxConfig::Get());
+  m_timer_pool.Stop();
+
+  //close views while loads are valid
+  std::vector<wxFrameChild*> frames = GetFrameChildren();
+  for (size_t idx_frm = 0; idx_frm < frames.size(); idx_frm++)
+  {
+    delete frames[idx_frm];
+  }
+
+  //stop worker
+  for (size_t idx_load = 0; idx_load < m_load.size(); idx_load++)
+  {
+    m_load[idx_load]->Cancel();
+  }
+  m_thread_load->m_queue.Post(NULL);
+  m_thread_load->Wait();
+  delete m_thread_load;
+  for (size_t idx_load = 0; idx_load < m_load.size(); idx_load++)
+  {
+    delete m_load[idx_load];
+  }
+
+  //stop open worker, skipping files not yet started
+  m_queue_open.Clear();
+  m_queue_open.Post(NULL);
+  m_thread_open->Wait();
+  delete m_thread_open;
+  for (size_t idx_fil = 0; idx_fil < m_open.size(); idx_fil++)
+  {
+    delete m_open[idx_fil];
+  }
+
+  nc_pool.close_all();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnTimerPool
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnTimerPool(wxTimerEvent& WXUNUSED(event))
+{
+  wxMutexLocker lock(nc_mutex);
+  nc_pool.expire();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::GetFrameChildren
+//open variable views
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<wxFrameChild*> wxFrameExplorer::GetFrameChildren()
+{
+  std::vector<wxFrameChild*> frames;
+  for (wxWindowList::iterator it = GetChildren().begin(); it != GetChildren().end(); ++it)
+  {
+    wxFrameChild *frame = dynamic_cast<wxFrameChild*>(*it);
+    if (frame != NULL)
+    {
+      frames.push_back(frame);
+    }
+  }
+  return frames;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::StartLoad
+//queue a background read of the variable buffer of item 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::StartLoad(wxItemData *item_data)
+{
+  //already being read
+  for (size_t idx_load = 0; idx_load < m_load.size(); idx_load++)
+  {
+    if (m_load[idx_load]->m_item_data == item_data && m_load[idx_load]->m_grid == NULL && !m_load[idx_load]->IsCancelled())
+    {
+      return;
+    }
+  }
+  QueueLoad(new ncload_t(item_data));
+  SetStatusText(wxString::Format(wxT("Loading %s..."), item_data->m_item_nm));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::QueueLoad
+//queue a background read; the load is deleted when done (a grid cancels its prefetch loads)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::QueueLoad(ncload_t *load)
+{
+  m_load.push_back(load);
+  m_thread_load->m_queue.Post(load);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::CancelLoad
+//a view was closed, cancel reading the item if no other view shows it
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::CancelLoad(wxItemData *item_data, wxFrameChild *frame_closed)
+{
+  std::vector<wxFrameChild*> frames = GetFrameChildren();
+  for (size_t idx_frm = 0; idx_frm < frames.size(); idx_frm++)
+  {
+    if (frames[idx_frm] != frame_closed && frames[idx_frm]->GetItemData() == item_data)
+    {
+      return;
+    }
+  }
+  for (size_t idx_load = 0; idx_load < m_load.size(); idx_load++)
+  {
+    if (m_load[idx_load]->m_item_data == item_data && m_load[idx_load]->m_grid == NULL)
+    {
+      m_load[idx_load]->Cancel();
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnCancelLoad
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnCancelLoad(wxCommandEvent& WXUNUSED(event))
+{
+  for (size_t idx_load = 0; idx_load < m_load.size(); idx_load++)
+  {
+    if (m_load[idx_load]->m_grid == NULL)
+    {
+      m_load[idx_load]->Cancel();
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnLoadProgress
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnLoadProgress(wxThreadEvent& event)
+{
+  ncload_t *load = event.GetPayload<ncload_t*>();
+  if (load->IsCancelled())
+  {
+    return;
+  }
+  SetStatusText(wxString::Format(wxT("Loading %s: %d%%"), load->m_item_data->m_item_nm, event.GetInt()));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnLoadDone
+//store the buffer read in the item and fill the views waiting for it
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnLoadDone(wxThreadEvent& event)
+{
+  ncload_t *load = event.GetPayload<ncload_t*>();
+  wxItemData *item_data = load->m_item_data;
+  m_load.erase(std::find(m_load.begin(), m_load.end(), load));
+
+  //layer prefetched by a grid (a cancelled load may belong to a closed grid)
+  if (load->m_grid != NULL)
+  {
+    if (!load->IsCancelled())
+    {
+      load->m_grid->StoreLayer(load);
+    }
+    delete load;
+    return;
+  }
+
+  if (load->IsCancelled())
+  {
+    SetStatusText(wxString::Format(wxT("Loading %s cancelled"), item_data->m_item_nm));
+  }
+  else if (load->m_status != NC_NOERR)
+  {
+    SetStatusText(wxString::Format(wxT("Loading %s failed: %s"), item_data->m_item_nm, nc_strerror(load->m_status)));
+  }
+  else if (item_data->m_ncvar->m_buf == NULL)
+  {
+    item_data->m_ncvar->store(std::move(load->m_buf));
+    nc_cache.insert(item_data->m_ncvar);
+    nc_cache.trim();
+    std::vector<wxFrameChild*> frames = GetFrameChildren();
+    for (size_t idx_frm = 0; idx_frm < frames.size(); idx_frm++)
+    {
+      if (frames[idx_frm]->GetItemData() == item_data)
+      {
+        frames[idx_frm]->UpdateGrid();
+      }
+    }
+    SetStatusText(GetCacheStatus());
+  }
+  delete load;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnQuit
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnQuit(wxCommandEvent& WXUNUSED(event))
+{
+  m_file_history.Save(*wxConfig::Get());
+  Close(true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnMRUFile
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnMRUFile(wxCommandEvent& event)
+{
+  wxString path(m_file_history.GetHistoryFile(event.GetId() - wxID_FILE1));
+  if (!path.empty())
+  {
+    OpenFile(path);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnFileOpen
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnFileOpen(wxCommandEvent &WXUNUSED(event))
+{
+  wxFileDialog dlg(this, wxT("Open file"),
+    wxEmptyString,
+    wxEmptyString,
+    wxString::Format
+    (
+      wxT("netCDF (*.nc)|*.nc|All files (%s)|%s"),
+      wxFileSelectorDefaultWildcardStr,
+      wxFileSelectorDefaultWildcardStr
+    ),
+    wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_CHANGE_DIR | wxFD_MULTIPLE);
+  if (dlg.ShowModal() != wxID_OK) return;
+  wxArrayString paths;
+  dlg.GetPaths(paths);
+  OpenFiles(paths);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnFileOpenDap
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnFileOpenDap(wxCommandEvent& WXUNUSED(event))
+{
+  wxTextEntryDialog dialog(this, wxT("OPeNDAP URL:"), wxT("OPeNDAP"));
+  if (dialog.ShowModal() == wxID_OK)
+  {
+    wxString path = dialog.GetValue();
+    OpenFile(path);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnSashDrag
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnSashDrag(wxSashEvent& event)
+{
+  int w, h;
+  GetClientSize(&w, &h);
+
+  if (event.GetDragStatus() == wxSASH_STATUS_OUT_OF_RANGE)
+    return;
+
+  switch (event.GetId())
+  {
+  case ID_WINDOW_SASH:
+    m_sash->SetDefaultSize(wxSize(event.GetDragRect().width, h));
+    break;
+  }
+
+  wxLayoutAlgorithm layout;
+  layout.LayoutMDIFrame(this);
+  GetClientWindow()->Refresh();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnSize
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnSize(wxSizeEvent& WXUNUSED(event))
+{
+  wxLayoutAlgorithm layout;
+  layout.LayoutMDIFrame(this);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OpenFiles
+//queue files to the open worker; each file subtree is appended in OnOpenDone when its scan ends
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OpenFiles(const wxArrayString& file_names)
+{
+  for (size_t idx_fil = 0; idx_fil < file_names.size(); idx_fil++)
+  {
+    ncopen_t *open = new ncopen_t(file_names[idx_fil]);
+    m_open.push_back(open);
+    m_queue_open.Post(open);
+  }
+  SetStatusText(wxString::Format(wxT("Opening %d files..."), static_cast<int>(m_open.size())));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OpenFile
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OpenFile(const wxString& file_name)
+{
+  wxArrayString file_names;
+  file_names.Add(file_name);
+  OpenFiles(file_names);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnOpenDone
+//root group of a file was scanned by a wxThreadOpen worker
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnOpenDone(wxThreadEvent& event)
+{
+  ncopen_t *open = event.GetPayload<ncopen_t*>();
+  m_open.erase(std::find(m_open.begin(), m_open.end(), open));
+  wxString file_name(open->m_file_name);
+
+  if (open->m_status != NC_NOERR)
+  {
+    SetStatusText(wxString::Format(wxT("Cannot open %s: %s"), file_name, nc_strerror(open->m_status)));
+  }
+  else
+  {
+    //root item
+    wxItemData *item_data = new wxItemData(wxItemData::Root,
+      open->m_file_name.c_str(),
+      "/",
+      "/",
+      (wxItemData*)NULL,
+      (ncvar_t*)NULL,
+      (grid_policy_t*)NULL);
+
+    //last component of full path file name used for root tree only
+    wxTreeItemId root = m_tree->AppendItem(m_tree_root, GetPathComponent(file_name), 0, 0, item_data);
+    size_t nbr_var = open->m_grp.m_ncvar.size();
+    AppendGroup(item_data->m_file_name, open->m_grp, root);
+    m_file_history.AddFileToHistory(file_name);
+    if (m_open.empty())
+    {
+      ncintern_t &names = nc_intern_table();
+      SetStatusText(wxString::Format(wxT("Opened %s: %lu variables in %ld ms, %lu names in %.1f KB"), file_name,
+        static_cast<unsigned long>(nbr_var), open->m_watch.Time(),
+        static_cast<unsigned long>(names.size()), names.memory() / 1024.0));
+    }
+    else
+    {
+      SetStatusText(wxString::Format(wxT("Opening %d files..."), static_cast<int>(m_open.size())));
+    }
+  }
+  delete open;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::ExpandGroup
+//iterate a group item on first expansion, replacing its dummy child
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::ExpandGroup(wxTreeItemId item_id)
+{
+  int nc_id;
+  int grp_id;
+  wxItemData *item_data = (wxItemData *)m_tree->GetItemData(item_id);
+  if (item_data == NULL || item_data->m_iterated)
+  {
+    return;
+  }
+
+  m_tree->DeleteChildren(item_id);
+  ncgrp_t grp;
+  int status;
+  {
+    wxMutexLocker lock(nc_mutex);
+    if ((status = OpenGroup(item_data->m_file_name, item_data->m_grp_nm_fll, &nc_id, &grp_id)) == NC_NOERR)
+    {
+      status = ScanGroup(grp_id, grp);
+    }
+  }
+
+  //group left empty, the error is shown
+  if (status != NC_NOERR)
+  {
+    item_data->m_iterated = true;
+    SetStatusText(wxString::Format(wxT("Cannot read group %s: %s"), item_data->m_grp_nm_fll, nc_strerror(status)));
+    return;
+  }
+  AppendGroup(item_data->m_file_name, grp, item_id);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::ScanGroup
+//read variables and sub-group names of one group (no tree access, called from workers with
+//nc_mutex locked); sub-groups are scanned when expanded; returns the status of the first library 
+//call that fails, grp is then incomplete
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int wxFrameExplorer::ScanGroup(const int grp_id, ncgrp_t &grp)
+{
+  char grp_nm[NC_MAX_NAME + 1]; // group name 
+  char var_nm[NC_MAX_NAME + 1]; // variable name 
+  char *grp_nm_fll = NULL; // group full name 
+  int nbr_att; // number of attributes 
+  int nbr_dmn_grp; // number of dimensions for group 
+  int nbr_var; // number of variables 
+  int nbr_grp; // number of sub-groups in this group 
+  int nbr_dmn_var; // number of dimensions for variable 
+  nc_type var_typ; // netCDF type 
+  std::vector<int> grp_ids; // sub-group IDs array
+  int nbr_var_sub; // number of variables in sub-group
+  int nbr_grp_sub; // number of sub-groups in sub-group
+  size_t grp_nm_lng; //lenght of full group name
+  int var_dimid[NC_MAX_VAR_DIMS]; // dimensions for variable
+  size_t dmn_sz[NC_MAX_VAR_DIMS]; // dimensions for variable sizes
+  char dmn_nm_var[NC_MAX_NAME + 1]; //dimension name
+  int storage; // NC_CONTIGUOUS or NC_CHUNKED
+  size_t chunk[NC_MAX_VAR_DIMS]; // chunk sizes
+  int shuffle; // shuffle filter
+  int deflate; // deflate filter
+  int deflate_level; // deflate level
+  int no_fill; // fill mode off
+  double fill[1]; // fill value, one element of any numeric type
+  int nbr_dmn_vis; // number of dimensions visible in group
+  int status;
+
+  // get full name of group
+  if ((status = nc_inq_grpname_full(grp_id, &grp_nm_lng, NULL)) != NC_NOERR)
+  {
+    return status;
+  }
+
+  grp_nm_fll = new char[grp_nm_lng + 1];
+
+  if ((status = nc_inq_grpname_full(grp_id, &grp_nm_lng, grp_nm_fll)) != NC_NOERR)
+  {
+    delete[] grp_nm_fll;
+    return status;
+  }
+  grp.m_grp_nm_fll = grp_nm_fll;
+  delete[] grp_nm_fll;
+
+  if ((status = nc_inq(grp_id, &nbr_dmn_grp, &nbr_var, &nbr_att, (int *)NULL)) != NC_NOERR)
+  {
+    return status;
+  }
+
+  //dimension table, dimensions belong to this group or to its parents
+  if (nc_inq_dimids(grp_id, &nbr_dmn_vis, NULL, 1) != NC_NOERR)
+  {
+    nbr_dmn_vis = 0;
+  }
+  grp.m_dimid.resize(nbr_dmn_vis);
+  if (nbr_dmn_vis > 0 && nc_inq_dimids(grp_id, &nbr_dmn_vis, &grp.m_dimid[0], 1) != NC_NOERR)
+  {
+    grp.m_dimid.clear();
+  }
+  grp.m_ncdim.reserve(grp.m_dimid.size());
+  for (size_t idx_dmn = 0; idx_dmn < grp.m_dimid.size(); idx_dmn++)
+  {
+    if (nc_inq_dim(grp_id, grp.m_dimid[idx_dmn], dmn_nm_var, &dmn_sz[0]) != NC_NOERR)
+    {
+      dmn_nm_var[0] = '\0';
+      dmn_sz[0] = 0;
+    }
+    grp.m_ncdim.push_back(ncdim_t(dmn_nm_var, dmn_sz[0]));
+  }
+
+  grp.m_ncvar.reserve(nbr_var);
+  std::vector<ncdim_t> ncdim; //dimensions for each variable, shared with the variables of same dimensions
+  for (int idx_var = 0; idx_var < nbr_var; idx_var++)
+  {
+    if ((status = nc_inq_var(grp_id, idx_var, var_nm, &var_typ, &nbr_dmn_var, var_dimid, &nbr_att)) != NC_NOERR)
+    {
+      return status;
+    }
+
+    //get dimensions from the table (names interned, no library call)
+    ncdim.clear();
+    for (int idx_dmn = 0; idx_dmn < nbr_dmn_var; idx_dmn++)
+    {
+      std::vector<int>::const_iterator it = std::find(grp.m_dimid.begin(), grp.m_dimid.end(), var_dimid[idx_dmn]);
+      if (it != grp.m_dimid.end())
+      {
+        ncdim.push_back(grp.m_ncdim[it - grp.m_dimid.begin()]);
+        continue;
+      }
+      if ((status = nc_inq_dim(grp_id, var_dimid[idx_dmn], dmn_nm_var, &dmn_sz[idx_dmn])) != NC_NOERR)
+      {
+        return status;
+      }
+      ncdim.push_back(ncdim_t(dmn_nm_var, dmn_sz[idx_dmn]));
+    }
+
+    //store a ncvar_t
+    ncvar_t *ncvar = new ncvar_t(var_nm, var_typ, grp.share(ncdim));
+    grp.m_ncvar.push_back(ncvar);
+
+    //storage (netCDF-4), reads are aligned to chunks
+    if (nbr_dmn_var > 0 && nc_inq_var_chunking(grp_id, idx_var, &storage, chunk) == NC_NOERR && storage == NC_CHUNKED)
+    {
+      ncvar->m_chunk.assign(chunk, chunk + nbr_dmn_var);
+    }
+    if (nc_inq_var_deflate(grp_id, idx_var, &shuffle, &deflate, &deflate_level) == NC_NOERR)
+    {
+      ncvar->m_deflate = deflate ? deflate_level : 0;
+      ncvar->m_shuffle = (shuffle != 0);
+    }
+    //fill value, counted by statistics
+    if (nc_is_numeric(var_typ) && nc_inq_var_fill(grp_id, idx_var, &no_fill, fill) == NC_NOERR)
+    {
+      ncvar->m_fill.assign(reinterpret_cast<unsigned char*>(fill), reinterpret_cast<unsigned char*>(fill) + nc_type_size(var_typ));
+    }
+  }
+
+  if ((status = nc_inq_grps(grp_id, &nbr_grp, (int *)NULL)) != NC_NOERR)
+  {
+    return status;
+  }
+
+  grp_ids.resize(nbr_grp);
+
+  if (nbr_grp > 0 && (status = nc_inq_grps(grp_id, &nbr_grp, &grp_ids[0])) != NC_NOERR)
+  {
+    return status;
+  }
+
+  for (int idx_grp = 0; idx_grp < nbr_grp; idx_grp++)
+  {
+    if ((status = nc_inq_grpname(grp_ids[idx_grp], grp_nm)) != NC_NOERR)
+    {
+      return status;
+    }
+    if (nc_inq_nvars(grp_ids[idx_grp], &nbr_var_sub) != NC_NOERR)
+    {
+      nbr_var_sub = 0;
+    }
+    if (nc_inq_grps(grp_ids[idx_grp], &nbr_grp_sub, (int *)NULL) != NC_NOERR)
+    {
+      nbr_grp_sub = 0;
+    }
+    grp.m_grp_nm.push_back(grp_nm);
+    grp.m_grp_empty.push_back(nbr_var_sub == 0 && nbr_grp_sub == 0);
+  }
+
+  return NC_NOERR;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::AppendGroup
+//append variables and sub-groups of a scanned group; sub-groups that are not empty get a dummy 
+//child so that they can be expanded; the variables are taken from grp
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::AppendGroup(const char *file_name, ncgrp_t &grp, wxTreeItemId item_id)
+{
+  //get item data (of parent item), to store an index of variable names 
+  wxItemData *item_data_prn = (wxItemData *)m_tree->GetItemData(item_id);
+  assert(item_data_prn->m_kind == wxItemData::Group || item_data_prn->m_kind == wxItemData::Root);
+  item_data_prn->m_iterated = true;
+  const char *grp_nm_fll = nc_intern(grp.m_grp_nm_fll.c_str());
+  item_data_prn->m_var_ids.reserve(item_data_prn->m_var_ids.size() + grp.m_ncvar.size());
+
+  for (size_t idx_var = 0; idx_var < grp.m_ncvar.size(); idx_var++)
+  {
+    ncvar_t *ncvar = grp.m_ncvar[idx_var];
+
+    //index variable name in parent group item (for coordinate variables detection), IDs are in scan order
+    item_data_prn->m_var_ids[ncvar->m_name] = static_cast<int>(idx_var);
+
+    //append item; the grid dimensions policy is defined when the variable is first shown
+    wxItemData *item_data_var = new wxItemData(wxItemData::Variable,
+      file_name,
+      grp_nm_fll,
+      ncvar->m_name,
+      item_data_prn,
+      ncvar,
+      (grid_policy_t*)NULL);
+    m_tree->AppendItem(item_id, wxString(ncvar->m_name), 1, 1, item_data_var);
+  }
+  grp.m_ncvar.clear();
+
+  for (size_t idx_grp = 0; idx_grp < grp.m_grp_nm.size(); idx_grp++)
+  {
+    const char *grp_nm = grp.m_grp_nm[idx_grp].c_str();
+
+    //group item, stores its own full name to be opened when expanded
+    std::string grp_nm_fll_sub(grp_nm_fll);
+    if (grp_nm_fll_sub != "/")
+    {
+      grp_nm_fll_sub += "/";
+    }
+    grp_nm_fll_sub += grp_nm;
+    wxItemData *item_data_grp = new wxItemData(wxItemData::Group,
+      file_name,
+      grp_nm_fll_sub.c_str(),
+      grp_nm,
+      item_data_prn,
+      (ncvar_t*)NULL,
+      (grid_policy_t*)NULL);
+    wxTreeItemId item_id_grp = m_tree->AppendItem(item_id, wxString(grp_nm), 0, 0, item_data_grp);
+
+    //dummy child (no item data), replaced in ExpandGroup
+    if (!grp.m_grp_empty[idx_grp])
+    {
+      m_tree->AppendItem(item_id_grp, wxEmptyString);
+    }
+    else
+    {
+      item_data_grp->m_iterated = true;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadOpen::Entry
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxThread::ExitCode wxThreadOpen::Entry()
+{
+  ncopen_t *open = NULL;
+  while (m_queue->Receive(open) == wxMSGQUEUE_NO_ERROR && open != NULL)
+  {
+    Scan(open);
+    wxThreadEvent *event = new wxThreadEvent(wxEVT_THREAD, ID_OPEN_DONE);
+    event->SetPayload(open);
+    wxQueueEvent(m_handler, event);
+  }
+  return static_cast<wxThread::ExitCode>(0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadOpen::Scan
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxThreadOpen::Scan(ncopen_t *open)
+{
+  int nc_id;
+  wxMutexLocker lock(nc_mutex);
+  if ((open->m_status = nc_pool.open(open->m_file_name.c_str(), &nc_id)) != NC_NOERR)
+  {
+    return;
+  }
+  open->m_status = wxFrameExplorer::ScanGroup(nc_id, open->m_grp);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxFrameExplorer::OnAbout
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxFrameExplorer::OnAbout(wxCommandEvent& WXUNUSED(event))
+{
+  wxMessageBox("(c) 2015 Pedro Vicente -- Space Research Software LLC\n\n", GetAppName(), wxOK, this);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::wxTreeCtrlExplorer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxBEGIN_EVENT_TABLE(wxTreeCtrlExplorer, wxTreeCtrl)
+EVT_TREE_SEL_CHANGED(wxID_ANY, wxTreeCtrlExplorer::OnSelChanged)
+EVT_TREE_ITEM_ACTIVATED(wxID_ANY, wxTreeCtrlExplorer::OnItemActivated)
+EVT_TREE_ITEM_MENU(wxID_ANY, wxTreeCtrlExplorer::OnItemMenu)
+EVT_TREE_ITEM_EXPANDING(wxID_ANY, wxTreeCtrlExplorer::OnItemExpanding)
+EVT_TREE_ITEM_GETTOOLTIP(wxID_ANY, wxTreeCtrlExplorer::OnItemGetToolTip)
+EVT_MENU(ID_TREE_LOAD_ITEM, wxTreeCtrlExplorer::OnLoadItem)
+EVT_MENU(ID_TREE_DIMENSIONS, wxTreeCtrlExplorer::OnDimensions)
+EVT_UPDATE_UI(ID_TREE_DIMENSIONS, wxTreeCtrlExplorer::OnUpdateDimensions)
+wxEND_EVENT_TABLE()
+
+wxTreeCtrlExplorer::wxTreeCtrlExplorer(wxWindow *parent, const wxWindowID id, const wxPoint& pos, const wxSize& size, long style)
+  : wxTreeCtrl(parent, id, pos, size, style)
+{
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::~wxTreeCtrlExplorer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxTreeCtrlExplorer::~wxTreeCtrlExplorer()
+{
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::ShowVariable
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::ShowVariable(wxItemData *item_data)
+{
+  wxSashLayoutWindow *sash = (wxSashLayoutWindow*)GetParent();
+  wxFrameExplorer *frame = (wxFrameExplorer*)sash->GetParent();
+
+  //if not loaded (or evicted from cache), read buffers from file 
+  //large variables are read in background, the view is shown empty and filled when read
+  bool load_async = !IsLoadLayer(item_data->m_ncvar) &&
+    item_data->m_ncvar->size() * item_data->m_ncvar->type_size() > min_async_size;
+  int status = LoadItem(item_data, !load_async);
+
+  //failed before the coordinate variables were detected, nothing to show
+  if (status != NC_NOERR && item_data->m_ncvar_crd.size() < item_data->m_ncvar->m_ncdim.size())
+  {
+    frame->SetStatusText(wxString::Format(wxT("Loading %s failed: %s"), item_data->m_item_nm, nc_strerror(status)));
+    return;
+  }
+
+  //show in grid
+  wxFrameChild *subframe = new wxFrameChild(frame,
+    wxString::Format(wxT("%s : %s"), GetPathComponent(item_data->m_file_name), item_data->m_item_nm),
+    item_data);
+  subframe->Show(true);
+
+  if (load_async && item_data->m_ncvar->m_buf == NULL && item_data->m_mmap_var == NULL)
+  {
+    frame->StartLoad(item_data);
+  }
+
+  //buffers of the new view are pinned, evict others over budget
+  nc_cache.trim();
+  if (status != NC_NOERR)
+  {
+    frame->SetStatusText(wxString::Format(wxT("Loading %s failed: %s"), item_data->m_item_nm, nc_strerror(status)));
+    return;
+  }
+  frame->SetStatusText(wxString::Format(wxT("%s: %s%s%s. %s"), item_data->m_item_nm, GetStorageInfo(item_data->m_ncvar),
+    (item_data->m_mmap_var != NULL) ? wxT(", mapped") : wxT(""),
+    item_data->m_pack.is_unpacked() ? wxT(", unpacked") : wxT(""), GetCacheStatus()));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnSelChanged
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnSelChanged(wxTreeEvent& event)
+{
+  event.Skip();
+#ifdef _DEBUG
+  wxTreeItemId item_id = event.GetItem();
+  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
+  if (item_data == NULL || item_data->m_kind != wxItemData::Variable)
+  {
+    return;
+  }
+  ShowVariable(item_data);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnItemActivated
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnItemActivated(wxTreeEvent& event)
+{
+  wxTreeItemId item_id = event.GetItem();
+  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
+  event.Skip();
+  if (item_data == NULL || item_data->m_kind != wxItemData::Variable)
+  {
+    return;
+  }
+  ShowVariable(item_data);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnItemExpanding
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnItemExpanding(wxTreeEvent& event)
+{
+  wxFrameExplorer *frame = (wxFrameExplorer*)GetParent()->GetParent();
+  frame->ExpandGroup(event.GetItem());
+  event.Skip();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnItemGetToolTip
+//dimensions and chunk geometry of a variable
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnItemGetToolTip(wxTreeEvent& event)
+{
+  wxItemData *item_data = (wxItemData *)GetItemData(event.GetItem());
+  if (item_data == NULL || item_data->m_kind != wxItemData::Variable)
+  {
+    return;
+  }
+  wxString str;
+  for (size_t idx_dmn = 0; idx_dmn < item_data->m_ncvar->m_ncdim.size(); idx_dmn++)
+  {
+    const ncdim_t &dim = item_data->m_ncvar->m_ncdim[idx_dmn];
+    str += wxString::Format(wxT("%s%s=%lu"), idx_dmn ? wxT(", ") : wxT(""), dim.m_name, static_cast<unsigned long>(dim.m_size));
+  }
+  str += wxT("\n") + GetStorageInfo(item_data->m_ncvar);
+  event.SetToolTip(str);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//IsResident
+//all buffers needed to show a variable item are loaded
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool IsResident(const wxItemData *item_data)
+{
+  if (item_data->m_ncvar_crd.size() != item_data->m_ncvar->m_ncdim.size())
+  {
+    return false;
+  }
+  for (size_t idx_dmn = 0; idx_dmn < item_data->m_ncvar_crd.size(); idx_dmn++)
+  {
+    if (item_data->m_ncvar_crd[idx_dmn] != NULL && item_data->m_ncvar_crd[idx_dmn]->m_buf == NULL &&
+      !IsLoadLayer(item_data->m_ncvar_crd[idx_dmn]))
+    {
+      return false;
+    }
+  }
+  return IsLoadLayer(item_data->m_ncvar) || item_data->m_ncvar->m_buf != NULL || item_data->m_mmap_var != NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::LoadItem
+//read variable and coordinate buffers that are not resident
+//load_var false reads only coordinate buffers (variable is read in background)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int wxTreeCtrlExplorer::LoadItem(wxItemData *item_data, bool load_var)
+{
+  char var_nm[NC_MAX_NAME + 1]; // variable name 
+  int status = NC_NOERR;
+  int nc_id;
+  int grp_id;
+  int var_id;
+  int fl_fmt;
+  nc_type var_type;
+  int nbr_dmn;
+  int var_dimid[NC_MAX_VAR_DIMS];
+
+  assert(item_data->m_kind == wxItemData::Variable);
+
+  //all buffers resident in cache, nothing to read
+  if (IsResident(item_data))
+  {
+    if (item_data->m_ncvar->m_buf != NULL)
+    {
+      nc_cache.touch(item_data->m_ncvar);
+    }
+    for (size_t idx_dmn = 0; idx_dmn < item_data->m_ncvar_crd.size(); idx_dmn++)
+    {
+      if (item_data->m_ncvar_crd[idx_dmn] != NULL)
+      {
+        nc_cache.touch(item_data->m_ncvar_crd[idx_dmn]);
+      }
+    }
+    return NC_NOERR;
+  }
+
+  wxMutexLocker lock(nc_mutex);
+
+  if ((status = OpenGroup(item_data->m_file_name, item_data->m_grp_nm_fll, &nc_id, &grp_id)) != NC_NOERR)
+  {
+    return status;
+  }
+
+  //all hunky dory from here 
+
+  // get variable ID, from the index of the group
+  std::unordered_map<const char*, int>::const_iterator it_var = item_data->m_item_data_prn->m_var_ids.find(item_data->m_item_nm);
+  if (it_var != item_data->m_item_data_prn->m_var_ids.end())
+  {
+    var_id = it_var->second;
+  }
+  else if ((status = nc_inq_varid(grp_id, item_data->m_item_nm, &var_id)) != NC_NOERR)
+  {
+    return status;
+  }
+
+  if ((status = nc_inq_var(grp_id, var_id, var_nm, &var_type, &nbr_dmn, var_dimid, (int *)NULL)) != NC_NOERR)
+  {
+    return status;
+  }
+
+  //classic format, variable shown from the mapped file with the same shape; the root group of a 
+  //netCDF-4 file has the ID of the file too, the format is checked
+  if (nc_mmap_enabled && item_data->m_mmap_var == NULL && nc_inq_format(nc_id, &fl_fmt) == NC_NOERR && 
+    fl_fmt != NC_FORMAT_NETCDF4 && fl_fmt != NC_FORMAT_NETCDF4_CLASSIC)
+  {
+    std::shared_ptr<ncmmap_t> mmap = MapFile(item_data->m_file_name);
+    const ncmmap_var_t *mmap_var = (mmap != NULL) ? mmap->find(std::string(item_data->m_item_nm)) : NULL;
+    bool is_shape = (mmap_var != NULL && mmap_var->m_nc_type == var_type && mmap_var->m_shape.size() == item_data->m_ncvar->m_ncdim.size());
+    for (size_t idx_dmn = 0; is_shape && idx_dmn < mmap_var->m_shape.size(); idx_dmn++)
+    {
+      is_shape = (mmap_var->m_shape[idx_dmn] == item_data->m_ncvar->m_ncdim[idx_dmn].m_size);
+    }
+    if (is_shape)
+    {
+      item_data->m_mmap = mmap;
+      item_data->m_mmap_var = mmap_var;
+    }
+  }
+
+  //packing attributes (first load only)
+  if (!item_data->m_pack_read)
+  {
+    nc_inq_pack(grp_id, var_id, var_type, item_data->m_ncvar->m_fill, item_data->m_pack);
+    item_data->m_pack_read = true;
+  }
+
+  //detect coordinate variables (first load only); a coordinate variable is a one-dimensional variable 
+  //of the same group named as the dimension, looked up in the group index and shared by all the 
+  //variables of the group through nc_coord
+  const std::unordered_map<const char*, int> &var_ids = item_data->m_item_data_prn->m_var_ids;
+  nbr_dmn = std::min<int>(nbr_dmn, static_cast<int>(item_data->m_ncvar->m_ncdim.size()));
+  for (int idx_dmn = 0; idx_dmn < nbr_dmn && item_data->m_ncvar_crd.size() < (size_t)nbr_dmn; idx_dmn++)
+  {
+    const char *dmn_nm = item_data->m_ncvar->m_ncdim[idx_dmn].m_name;
+    ncvar_t *ncvar = nc_coord.acquire(item_data->m_file_name, item_data->m_grp_nm_fll, dmn_nm);
+    std::unordered_map<const char*, int>::const_iterator it = var_ids.find(dmn_nm);
+
+    if (ncvar == NULL && it != var_ids.end())
+    {
+      char crd_var_nm[NC_MAX_NAME + 1];
+      int crd_nbr_dmn;
+      int crd_var_dimid[NC_MAX_VAR_DIMS];
+      nc_type crd_var_type = NC_NAT;
+
+      if (nc_inq_var(grp_id, it->second, crd_var_nm, &crd_var_type, &crd_nbr_dmn, crd_var_dimid, (int *)NULL) != NC_NOERR)
+      {
+        crd_nbr_dmn = 0;
+      }
+
+      if (crd_nbr_dmn == 1)
+      {
+        //store dimension 
+        std::vector<ncdim_t> ncdim; //dimensions for each variable 
+        ncdim.push_back(item_data->m_ncvar->m_ncdim[idx_dmn]);
+
+        //store a ncvar_t (buffer is read below), shared with the other variables of the group
+        ncvar = new ncvar_t(crd_var_nm, crd_var_type, ncdim);
+        nc_coord.insert(item_data->m_file_name, item_data->m_grp_nm_fll, dmn_nm, ncvar);
+      }
+    }
+
+    //and store in tree (NULL if no coordinate variable for this dimension)
+    item_data->m_ncvar_crd.push_back(ncvar);
+  }
+
+  //read coordinate buffers not resident (first load or evicted from cache); coordinates read by layers 
+  //(IsLoadLayer) or that fail to read are not stored, labels are indices
+  for (size_t idx_dmn = 0; idx_dmn < item_data->m_ncvar_crd.size(); idx_dmn++)
+  {
+    ncvar_t *ncvar = item_data->m_ncvar_crd[idx_dmn];
+    ncbuf_t buf;
+    int crd_var_id;
+    if (ncvar == NULL || IsLoadLayer(ncvar))
+    {
+      continue;
+    }
+    if (ncvar->m_buf != NULL)
+    {
+      nc_cache.touch(ncvar);
+      continue;
+    }
+    std::unordered_map<const char*, int>::const_iterator it = var_ids.find(ncvar->m_name);
+    if (it != var_ids.end())
+    {
+      crd_var_id = it->second;
+    }
+    else if ((status = nc_inq_varid(grp_id, ncvar->m_name, &crd_var_id)) != NC_NOERR)
+    {
+      continue;
+    }
+    if ((status = LoadVariable(grp_id, crd_var_id, ncvar->m_nc_type, ncvar->size(), buf)) != NC_NOERR)
+    {
+      continue;
+    }
+    ncvar->store(std::move(buf));
+    nc_cache.insert(ncvar);
+  }
+
+  //allocate buffer and store in item data; large variables are read per layer by the grid, mapped 
+  //variables are not read
+  if (!IsLoadLayer(item_data->m_ncvar) && item_data->m_mmap_var == NULL)
+  {
+    if (item_data->m_ncvar->m_buf != NULL)
+    {
+      nc_cache.touch(item_data->m_ncvar);
+    }
+    else if (load_var)
+    {
+      ncbuf_t buf;
+      if ((status = LoadVariable(grp_id, var_id, var_type, item_data->m_ncvar->size(), buf)) != NC_NOERR)
+      {
+        return status;
+      }
+      item_data->m_ncvar->store(std::move(buf));
+      nc_cache.insert(item_data->m_ncvar);
+    }
+  }
+  return status;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::LoadVariable
+//read whole variable, or a hyperslab of buf_sz elements if start and count are supplied, into buf; 
+//on error buf is empty
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int wxTreeCtrlExplorer::LoadVariable(const int nc_id, const int var_id, const nc_type var_type, size_t buf_sz, ncbuf_t &buf,
+  const size_t *start, const size_t *count)
+{
+  size_t start_var[NC_MAX_VAR_DIMS];
+  size_t count_var[NC_MAX_VAR_DIMS];
+  int status;
+
+  buf.reset();
+
+  //whole variable, hyperslab is all the dimensions
+  if (start == NULL)
+  {
+    int nbr_dmn;
+    int var_dimid[NC_MAX_VAR_DIMS];
+    if ((status = nc_inq_varndims(nc_id, var_id, &nbr_dmn)) != NC_NOERR)
+    {
+      return status;
+    }
+    if ((status = nc_inq_vardimid(nc_id, var_id, var_dimid)) != NC_NOERR)
+    {
+      return status;
+    }
+    for (int idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
+    {
+      start_var[idx_dmn] = 0;
+      if ((status = nc_inq_dimlen(nc_id, var_dimid[idx_dmn], &count_var[idx_dmn])) != NC_NOERR)
+      {
+        return status;
+      }
+    }
+    start = start_var;
+    count = count_var;
+  }
+
+  buf = ncbuf_t(var_type, buf_sz);
+  if (!buf.empty() && (status = ReadVariable(nc_id, var_id, var_type, start, count, buf.data())) != NC_NOERR)
+  {
+    buf.reset();
+    return status;
+  }
+  return NC_NOERR;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::ReadVariable
+//read hyperslab into an allocated buffer
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int wxTreeCtrlExplorer::ReadVariable(const int nc_id, const int var_id, const nc_type var_type,
+  const size_t *start, const size_t *count, void *buf)
+{
+  ncread_t visitor(nc_id, var_id, start, count);
+  nc_visit(var_type, buf, visitor);
+  return visitor.m_status;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ReadLoad
+//read a hyperslab of the variable of a load into buf; from the mapping if the variable is mapped 
+//(without nc_mutex, the mapping is read only), otherwise with the library under nc_mutex
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ReadLoad(ncload_t *load, const size_t *start, const size_t *count, void *buf)
+{
+  int nc_id;
+  int grp_id;
+  int var_id;
+  int status;
+  if (load->m_mmap_var != NULL)
+  {
+    return load->m_mmap->read(*load->m_mmap_var, start, count, buf);
+  }
+  wxMutexLocker lock(nc_mutex);
+  if ((status = nc_pool.open_group(load->m_file_name.c_str(), load->m_grp_nm_fll.c_str(), &nc_id, &grp_id)) != NC_NOERR ||
+    (status = nc_inq_varid(grp_id, load->m_var_nm.c_str(), &var_id)) != NC_NOERR)
+  {
+    return status;
+  }
+  SetChunkCache(grp_id, var_id, load->m_chunk_cache, load->m_chunk_nbr);
+  return wxTreeCtrlExplorer::ReadVariable(grp_id, var_id, load->m_nc_type, start, count, buf);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadLoad::Entry
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxThread::ExitCode wxThreadLoad::Entry()
+{
+  ncload_t *load = NULL;
+  while (m_queue.Receive(load) == wxMSGQUEUE_NO_ERROR && load != NULL)
+  {
+    if (!load->IsCancelled())
+    {
+      Read(load);
+    }
+    wxThreadEvent *event = new wxThreadEvent(wxEVT_THREAD, ID_LOAD_DONE);
+    event->SetPayload(load);
+    wxQueueEvent(m_handler, event);
+  }
+  return static_cast<wxThread::ExitCode>(0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//StreamLoad
+//read the hyperslab of a load in hyperslabs of consecutive indices of the first dimension, about 
+//load_chunk_size bytes each and ending on chunk boundaries (GetReadRows); nc_mutex is released 
+//between hyperslabs (ReadLoad), so the GUI thread can use the library
+//with a buffer of the whole hyperslab of the load, each hyperslab is read in place and 
+//slab(buf, idx, nbr) is called after it is read; without (buf NULL), hyperslabs are read in two 
+//buffers in turn and slab is called for one in another thread while the next one is read, so that 
+//no buffer of the whole hyperslab is allocated; idx is the index in the load of the first of the nbr 
+//elements of the hyperslab; reading stops when slab returns false or the load is cancelled
+//returns the netCDF status (also in load->m_status)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename F>
+int StreamLoad(ncload_t *load, ncbuf_t *buf, F slab)
+{
+  size_t start[NC_MAX_VAR_DIMS];
+  size_t count[NC_MAX_VAR_DIMS];
+  size_t nbr_dmn = load->m_start.size();
+  size_t type_size = nc_type_size(load->m_nc_type);
+  size_t row_sz = 1; // number of elements for one index of the first dimension
+  size_t nbr_row = (nbr_dmn > 0) ? load->m_count[0] : 1;
+  size_t nbr_row_chunk;
+  ncbuf_t buf_slab[2]; // (no buffer) hyperslab read, hyperslab passed to slab
+  std::thread thread;
+  bool more = true; // slab returned true
+  bool more_thread = true; // slab returned true, in thread
+  wxStopWatch watch;
+
+  for (size_t idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
+  {
+    start[idx_dmn] = load->m_start[idx_dmn];
+    count[idx_dmn] = load->m_count[idx_dmn];
+    if (idx_dmn > 0)
+    {
+      row_sz *= count[idx_dmn];
+    }
+  }
+  nbr_row_chunk = (row_sz * type_size > 0) ? std::max<size_t>(1, load_chunk_size / (row_sz * type_size)) : nbr_row;
+
+  load->m_status = NC_NOERR;
+  size_t nbr_row_read;
+  int idx_buf = 0;
+  for (size_t idx_row = 0; idx_row < nbr_row && more && !load->IsCancelled(); idx_row += nbr_row_read)
+  {
+    nbr_row_read = GetReadRows(load->m_chunk, load->m_start.empty() ? 0 : load->m_start[0] + idx_row, nbr_row_chunk, nbr_row - idx_row);
+    if (nbr_dmn > 0)
+    {
+      start[0] = load->m_start[0] + idx_row;
+      count[0] = nbr_row_read;
+    }
+    size_t idx = idx_row * row_sz;
+    size_t nbr = nbr_row_read * row_sz;
+
+    //buffers are reused, but for strings (freed by the buffer)
+    void *buf_read;
+    if (buf != NULL)
+    {
+      buf_read = buf->at(idx);
+    }
+    else
+    {
+      if (buf_slab[idx_buf].empty() || buf_slab[idx_buf].size() < nbr || load->m_nc_type == NC_STRING)
+      {
+        buf_slab[idx_buf] = ncbuf_t(load->m_nc_type, std::max<size_t>(1, nbr));
+      }
+      if ((buf_read = buf_slab[idx_buf].data()) == NULL)
+      {
+        load->m_status = NC_ENOMEM;
+        break;
+      }
+    }
+
+    if ((load->m_status = ReadLoad(load, start, count, buf_read)) != NC_NOERR)
+    {
+      break;
+    }
+
+    if (buf != NULL)
+    {
+      more = slab(static_cast<const void*>(buf_read), idx, nbr);
+      continue;
+    }
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+    if (!(more = more_thread))
+    {
+      break;
+    }
+    thread = std::thread([=, &slab, &more_thread]() { more_thread = slab(static_cast<const void*>(buf_read), idx, nbr); });
+    idx_buf = 1 - idx_buf;
+  }
+  if (thread.joinable())
+  {
+    thread.join();
+  }
+  load->m_time = watch.Time();
+  return load->m_status;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadLoad::Read
+//read buffer in hyperslabs (StreamLoad), posting the progress
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxThreadLoad::Read(ncload_t *load)
+{
+  size_t buf_sz = 1; // number of elements
+  int percent_prv = -1;
+  wxStopWatch watch;
+
+  for (size_t idx_dmn = 0; idx_dmn < load->m_count.size(); idx_dmn++)
+  {
+    buf_sz *= load->m_count[idx_dmn];
+  }
+
+  //zeroed, so that a partial NC_STRING buffer can be freed
+  load->m_buf = ncbuf_t(load->m_nc_type, buf_sz, true);
+  if (load->m_buf.empty())
+  {
+    load->m_status = NC_ENOMEM;
+    return;
+  }
+
+  if (StreamLoad(load, &load->m_buf, [&](const void*, size_t idx, size_t nbr) -> bool
+  {
+    int percent = buf_sz ? static_cast<int>((100.0 * (idx + nbr)) / buf_sz) : 100;
+    if (percent != percent_prv && load->m_grid == NULL)
+    {
+      wxThreadEvent *event = new wxThreadEvent(wxEVT_THREAD, ID_LOAD_PROGRESS);
+      event->SetInt(percent);
+      event->SetPayload(load);
+      wxQueueEvent(m_handler, event);
+      percent_prv = percent;
+    }
+    return true;
+  }) != NC_NOERR || load->IsCancelled())
+  {
+    return;
+  }
+  if (load->m_transpose && (load->m_buf = TransposeLayer(std::move(load->m_buf),
+    load->m_ncdim[0].m_size, load->m_ncdim[1].m_size)).empty())
+  {
+    load->m_status = NC_ENOMEM;
+  }
+  load->m_time = watch.Time();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//StatsLoad
+//add the statistics of the hyperslab of a load to stats, streamed from file (StreamLoad); values
+//of a packed variable are unpacked (pack) before statistics
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int StatsLoad(ncload_t *load, const std::vector<unsigned char> &fill, const ncpack_t &pack, ncstats_t &stats)
+{
+  nc_type nc_typ = load->m_nc_type;
+  if (!nc_is_numeric(nc_typ))
+  {
+    return load->m_status = NC_EBADTYPE;
+  }
+  return StreamLoad(load, NULL, [&](const void *buf, size_t, size_t nbr) -> bool
+  {
+    nc_stats_unpack(nc_typ, buf, nbr, fill, pack, stats);
+    return true;
+  });
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadScan::Entry
+//scan the resident buffer, or stream the variable from file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxThread::ExitCode wxThreadScan::Entry()
+{
+  if (m_buf != NULL)
+  {
+    size_t buf_sz = 1;
+    for (size_t idx_dmn = 0; idx_dmn < m_load->m_count.size(); idx_dmn++)
+    {
+      buf_sz *= m_load->m_count[idx_dmn];
+    }
+    Scan(m_buf, 0, buf_sz);
+  }
+  else if (!nc_is_numeric(m_load->m_nc_type))
+  {
+    m_load->m_status = NC_EBADTYPE;
+  }
+  else
+  {
+    StreamLoad(m_load, NULL, [this](const void *buf, size_t idx, size_t nbr) { return Scan(buf, idx, nbr); });
+  }
+  wxQueueEvent(m_handler, new wxThreadEvent(wxEVT_THREAD, m_id_done));
+  return static_cast<wxThread::ExitCode>(0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadStats::Scan
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool wxThreadStats::Scan(const void *buf, size_t WXUNUSED(idx), size_t nbr)
+{
+  nc_stats_unpack(m_load->m_nc_type, buf, nbr, m_fill, m_pack, m_stats);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxThreadFind::Scan
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool wxThreadFind::Scan(const void *buf, size_t idx, size_t nbr)
+{
+  nc_find_unpack(m_load->m_nc_type, buf, nbr, m_fill, m_pack, m_find, idx, max_find_hits, m_hits);
+  return m_hits.size() < max_find_hits;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::ShowGrid
+//locate the current layer in the buffer; cells are formatted by the table when painted
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxGridLayers::ShowGrid()
+{
+  size_t idx_buf;
+
+  //tile mode, tiles of the current layer are read when painted
+  if (m_tiles != NULL)
+  {
+    m_tiles->clear();
+    m_idx_layer = 0;
+    this->ForceRefresh();
+    return;
+  }
+
+  //layer mode, read the current layer only (unless prefetched); a layer still being prefetched is 
+  //shown empty and filled by StoreLayer, instead of being read again here; mapped variables are 
+  //addressed in the mapping as resident ones in their buffer
+  if (IsLoadLayer(m_ncvar) && m_item_data->m_mmap_var == NULL)
+  {
+    std::map<std::vector<int>, ncvar_t *>::iterator it = m_layer_buf.find(m_layer);
+    if (it != m_layer_buf.end())
+    {
+      m_ncvar_layer = it->second;
+    }
+    else if (m_layer_load.count(m_layer))
+    {
+      std::vector<ncdim_t> ncdim;
+      ncdim.push_back(m_ncvar->m_ncdim[m_dim_rows]);
+      ncdim.push_back(m_ncvar->m_ncdim[m_dim_cols]);
+      m_ncvar_layer = new ncvar_t(m_ncvar->m_name, m_ncvar->m_nc_type, ncdim);
+      m_ncvar_layer->m_fill = m_ncvar->m_fill;
+      m_layer_buf[m_layer] = m_ncvar_layer;
+    }
+    else
+    {
+      m_ncvar_layer = LoadLayer(m_layer);
+      m_layer_buf[m_layer] = m_ncvar_layer;
+    }
+    m_table->SetVariable(m_ncvar_layer);
+    m_table->SetLayer(0, ncstride_t(m_nbr_cols));
+    m_idx_layer = 0;
+    this->ForceRefresh();
+    return;
+  }
+
+  idx_buf = m_stride.offset(m_layer);
+  m_table->SetLayer(idx_buf, m_stride);
+  m_idx_layer = idx_buf;
+  this->ForceRefresh();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::GetLayer
+//variable whose buffer holds the current layer (the layer itself in layer mode), index in buffer 
+//and number of elements of the layer; the buffer is NULL while being read
+//for a mapped variable, and for rows and columns that are not contiguous in the buffer (Dimensions),
+//the current layer is copied, rows x columns in native order (only the last one is kept); NULL for 
+//NC_STRING layers that would need a copy
+//for a packed variable the layer is unpacked (only the current one is kept); the type and _FillValue
+//of the layer returned are those of the unpacked values
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ncvar_t* wxGridLayers::GetLayer(size_t &idx_buf, size_t &nbr)
+{
+  const ncpack_t &pack = m_item_data->m_pack;
+  ncvar_t *ncvar_layer = GetLayerStored(idx_buf, nbr);
+  if (!pack.is_unpacked() || ncvar_layer == NULL || ncvar_layer->m_buf == NULL)
+  {
+    return ncvar_layer;
+  }
+  const void *buf_layer = static_cast<const char*>(ncvar_layer->m_buf) + idx_buf * ncvar_layer->type_size();
+  idx_buf = 0;
+  if (m_ncvar_unpack != NULL && m_layer_unpack == m_layer)
+  {
+    return m_ncvar_unpack;
+  }
+  delete m_ncvar_unpack;
+  std::vector<ncdim_t> ncdim;
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_rows]);
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_cols]);
+  m_ncvar_unpack = new ncvar_t(m_ncvar->m_name, pack.m_nc_type, ncdim);
+  m_ncvar_unpack->m_fill = pack.fill();
+  ncbuf_t buf(pack.m_nc_type, nbr);
+  if (!buf.empty())
+  {
+    nc_unpack_parallel(m_ncvar->m_nc_type, buf_layer, nbr, pack, buf.data());
+  }
+  m_ncvar_unpack->store(std::move(buf));
+  m_layer_unpack = m_layer;
+  return m_ncvar_unpack;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::GetLayerStored
+//current layer as stored (see GetLayer)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ncvar_t* wxGridLayers::GetLayerStored(size_t &idx_buf, size_t &nbr)
+{
+  bool is_mapped = (m_item_data->m_mmap_var != NULL);
+  nbr = static_cast<size_t>(m_nbr_rows) * m_nbr_cols;
+  idx_buf = m_idx_layer;
+  if (IsLoadLayer(m_ncvar) && !is_mapped)
+  {
+    return m_ncvar_layer;
+  }
+  if (!is_mapped && (m_ncvar->m_buf == NULL || 
+    (m_stride.m_stride_cols == 1 && m_stride.m_stride_rows == static_cast<size_t>(m_nbr_cols))))
+  {
+    return m_ncvar;
+  }
+  if (m_ncvar->m_nc_type == NC_STRING)
+  {
+    return NULL;
+  }
+
+  //copy of the layer, rows x columns
+  idx_buf = 0;
+  std::map<std::vector<int>, ncvar_t *>::iterator it = m_layer_buf.find(m_layer);
+  if (it != m_layer_buf.end())
+  {
+    return it->second;
+  }
+  for (it = m_layer_buf.begin(); it != m_layer_buf.end(); ++it)
+  {
+    delete it->second;
+  }
+  m_layer_buf.clear();
+  std::vector<ncdim_t> ncdim;
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_rows]);
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_cols]);
+  ncvar_t *ncvar_layer = new ncvar_t(m_ncvar->m_name, m_ncvar->m_nc_type, ncdim);
+  ncvar_layer->m_fill = m_ncvar->m_fill;
+  ncbuf_t buf(m_ncvar->m_nc_type, nbr);
+  if (!buf.empty() && is_mapped)
+  {
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    GetLayerSlab(m_layer, start, count);
+    if (m_item_data->m_mmap->read(*m_item_data->m_mmap_var, &start[0], &count[0], buf.data()) != NC_NOERR)
+    {
+      buf.reset();
+    }
+    else if (m_dim_rows > m_dim_cols)
+    {
+      buf = TransposeLayer(std::move(buf), m_nbr_rows, m_nbr_cols);
+    }
+  }
+  else if (!buf.empty())
+  {
+    nc_transpose_parallel(m_ncvar->m_nc_type, m_ncvar->m_buf, m_idx_layer, m_stride.m_stride_rows, m_stride.m_stride_cols,
+      m_nbr_rows, m_nbr_cols, buf.data());
+  }
+  ncvar_layer->store(std::move(buf));
+  m_layer_buf[m_layer] = ncvar_layer;
+  return ncvar_layer;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::GetLayerSlab
+//hyperslab of a layer (index for layer dimensions, rows and columns whole)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxGridLayers::GetLayerSlab(const std::vector<int> &layer, std::vector<size_t> &start, std::vector<size_t> &count)
+{
+  start.assign(m_ncvar->m_ncdim.size(), 0);
+  count.clear();
+  for (size_t idx_dmn = 0; idx_dmn < m_ncvar->m_ncdim.size(); idx_dmn++)
+  {
+    count.push_back(m_ncvar->m_ncdim[idx_dmn].m_size);
+  }
+  for (size_t idx_dmn = 0; idx_dmn < layer.size(); idx_dmn++)
+  {
+    int dim_layer = m_grid_policy.m_dim_layers[idx_dmn];
+    start[dim_layer] = layer[idx_dmn];
+    count[dim_layer] = 1;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::LoadLayer
+//read a layer from file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ncvar_t* wxGridLayers::LoadLayer(const std::vector<int> &layer)
+{
+  int nc_id;
+  int grp_id;
+  int var_id;
+  std::vector<size_t> start;
+  std::vector<size_t> count;
+  std::vector<ncdim_t> ncdim; //dimensions of layer 
+  wxStopWatch watch;
+
+  GetLayerSlab(layer, start, count);
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_rows]);
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_cols]);
+  ncvar_t *ncvar_layer = new ncvar_t(m_ncvar->m_name, m_ncvar->m_nc_type, ncdim);
+  ncvar_layer->m_fill = m_ncvar->m_fill;
+
+  wxMutexLocker lock(nc_mutex);
+  if (OpenGroup(m_item_data->m_file_name, m_item_data->m_grp_nm_fll, &nc_id, &grp_id) != NC_NOERR)
+  {
+    return ncvar_layer;
+  }
+
+  if (nc_inq_varid(grp_id, m_item_data->m_item_nm, &var_id) != NC_NOERR)
+  {
+    return ncvar_layer;
+  }
+
+  SetChunkCache(grp_id, var_id, m_chunk_cache, m_chunk_nbr);
+  ncbuf_t buf;
+  if (wxTreeCtrlExplorer::LoadVariable(grp_id, var_id, m_ncvar->m_nc_type,
+    static_cast<size_t>(m_nbr_rows) * m_nbr_cols, buf, &start[0], &count[0]) != NC_NOERR)
+  {
+    return ncvar_layer;
+  }
+  if (m_dim_rows > m_dim_cols)
+  {
+    buf = TransposeLayer(std::move(buf), m_nbr_rows, m_nbr_cols);
+  }
+  ncvar_layer->store(std::move(buf));
+  m_time_read = (m_time_read * 3 + watch.Time()) / 4;
+  return ncvar_layer;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::ReadTile
+//read nbr_rows x nbr_cols elements at (row, col) of the current layer from file (tile mode)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ncbuf_t wxGridLayers::ReadTile(size_t row, size_t col, size_t nbr_rows, size_t nbr_cols)
+{
+  int nc_id;
+  int grp_id;
+  int var_id;
+  std::vector<size_t> start;
+  std::vector<size_t> count;
+  wxStopWatch watch;
+
+  GetLayerSlab(m_layer, start, count);
+  start[m_dim_rows] = row;
+  count[m_dim_rows] = nbr_rows;
+  if (m_dim_cols >= 0)
+  {
+    start[m_dim_cols] = col;
+    count[m_dim_cols] = nbr_cols;
+  }
+
+  wxMutexLocker lock(nc_mutex);
+  if (OpenGroup(m_item_data->m_file_name, m_item_data->m_grp_nm_fll, &nc_id, &grp_id) != NC_NOERR ||
+    nc_inq_varid(grp_id, m_item_data->m_item_nm, &var_id) != NC_NOERR)
+  {
+    return ncbuf_t();
+  }
+  SetChunkCache(grp_id, var_id, m_chunk_cache, m_chunk_nbr);
+  ncbuf_t buf;
+  if (wxTreeCtrlExplorer::LoadVariable(grp_id, var_id, m_ncvar->m_nc_type, nbr_rows * nbr_cols, buf, &start[0], &count[0]) != NC_NOERR)
+  {
+    return ncbuf_t();
+  }
+  if (m_dim_cols >= 0 && m_dim_rows > m_dim_cols)
+  {
+    buf = TransposeLayer(std::move(buf), nbr_rows, nbr_cols);
+  }
+  m_time_read = (m_time_read * 3 + watch.Time()) / 4;
+  return buf;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::Prefetch
+//layer dimension idx_dmn was stepped in direction dir (1 forward, -1 back); keep the next and 
+//previous layers along it read ahead in background
+//the window of layers grows when steps come faster than a layer can be read, up to
+//max_prefetch_size bytes; layers outside the window are released
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const size_t max_prefetch_size = 256 * 1024 * 1024; //bytes
+const int max_prefetch_layers = 16; //layers each side
+
+void wxGridLayers::Prefetch(size_t idx_dmn, int dir)
+{
+  if (!IsLoadLayer(m_ncvar) || m_item_data->m_mmap_var != NULL || m_tiles != NULL)
+  {
+    return;
+  }
+
+  //stepping interval 
+  long time_now = m_watch_step.Time();
+  long time_step = time_now - m_time_step;
+  m_time_step = time_now;
+
+  size_t layer_size = static_cast<size_t>(m_nbr_rows) * m_nbr_cols * m_ncvar->type_size();
+  int nbr_max = static_cast<int>(std::min<size_t>(max_prefetch_layers, std::max<size_t>(1, max_prefetch_size / (2 * layer_size + 1))));
+  int nbr = 1;
+  if (time_step > 0 && time_step < 2000)
+  {
+    nbr = std::min<int>(nbr_max, 1 + static_cast<int>(m_time_read / time_step));
+  }
+
+  int idx_cur = m_layer[idx_dmn];
+  int idx_max = static_cast<int>(m_ncvar->m_ncdim[m_grid_policy.m_dim_layers[idx_dmn]].m_size) - 1;
+
+  //a layer is in the window if it differs from the current layer only along idx_dmn, by at most nbr
+  std::vector<std::vector<int> > layers_out;
+  for (std::map<std::vector<int>, ncvar_t *>::iterator it = m_layer_buf.begin(); it != m_layer_buf.end(); ++it)
+  {
+    std::vector<int> layer = it->first;
+    int idx = layer[idx_dmn];
+    layer[idx_dmn] = idx_cur;
+    if (layer != m_layer || std::abs(idx - idx_cur) > nbr)
+    {
+      layers_out.push_back(it->first);
+    }
+  }
+  for (size_t idx_out = 0; idx_out < layers_out.size(); idx_out++)
+  {
+    delete m_layer_buf[layers_out[idx_out]];
+    m_layer_buf.erase(layers_out[idx_out]);
+  }
+  layers_out.clear();
+  for (std::map<std::vector<int>, ncload_t *>::iterator it = m_layer_load.begin(); it != m_layer_load.end(); ++it)
+  {
+    std::vector<int> layer = it->first;
+    int idx = layer[idx_dmn];
+    layer[idx_dmn] = idx_cur;
+    if (layer != m_layer || std::abs(idx - idx_cur) > nbr)
+    {
+      it->second->Cancel();
+      layers_out.push_back(it->first);
+    }
+  }
+  for (size_t idx_out = 0; idx_out < layers_out.size(); idx_out++)
+  {
+    m_layer_load.erase(layers_out[idx_out]);
+  }
+
+  //queue layers ahead in stepping direction first, then behind
+  std::vector<ncdim_t> ncdim;
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_rows]);
+  ncdim.push_back(m_ncvar->m_ncdim[m_dim_cols]);
+  wxFrameExplorer *frame = (wxFrameExplorer*)GetParent()->GetParent()->GetParent();
+  for (int side = 0; side < 2; side++)
+  {
+    int dir_side = (side == 0) ? dir : -dir;
+    for (int idx_step = 1; idx_step <= nbr; idx_step++)
+    {
+      std::vector<int> layer(m_layer);
+      layer[idx_dmn] = idx_cur + dir_side * idx_step;
+      if (layer[idx_dmn] < 0 || layer[idx_dmn] > idx_max)
+      {
+        break;
+      }
+      if (m_layer_buf.count(layer) || m_layer_load.count(layer))
+      {
+        continue;
+      }
+      std::vector<size_t> start;
+      std::vector<size_t> count;
+      GetLayerSlab(layer, start, count);
+      ncload_t *load = new ncload_t(m_item_data, this, layer, start, count, ncdim);
+      load->m_transpose = (m_dim_rows > m_dim_cols);
+      load->m_chunk_cache = m_chunk_cache;
+      load->m_chunk_nbr = m_chunk_nbr;
+      m_layer_load[layer] = load;
+      frame->QueueLoad(load);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::StoreLayer
+//a prefetched layer was read; if it is the current layer, shown empty while being read (ShowGrid), 
+//the view is filled (a failed read is retried by ShowGrid)
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxGridLayers::StoreLayer(ncload_t *load)
+{
+  m_layer_load.erase(load->m_layer);
+  std::map<std::vector<int>, ncvar_t *>::iterator it = m_layer_buf.find(load->m_layer);
+  ncvar_t *ncvar_layer = (it != m_layer_buf.end()) ? it->second : NULL;
+  if (ncvar_layer != NULL && ncvar_layer->m_buf != NULL)
+  {
+    return;
+  }
+  if (load->m_status != NC_NOERR)
+  {
+    if (ncvar_layer == NULL)
+    {
+      return;
+    }
+    delete ncvar_layer;
+    m_layer_buf.erase(it);
+  }
+  else
+  {
+    if (ncvar_layer == NULL)
+    {
+      ncvar_layer = new ncvar_t(m_ncvar->m_name, m_ncvar->m_nc_type, load->m_ncdim);
+      ncvar_layer->m_fill = m_ncvar->m_fill;
+      m_layer_buf[load->m_layer] = ncvar_layer;
+    }
+    ncvar_layer->store(std::move(load->m_buf));
+    m_time_read = (m_time_read * 3 + load->m_time) / 4;
+  }
+  if (load->m_layer == m_layer)
+  {
+    wxFrameChild *frame = (wxFrameChild*)GetParent()->GetParent();
+    frame->UpdateGrid();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridTableLayers::wxGridTableLayers
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxGridTableLayers::wxGridTableLayers(ncvar_t *ncvar, const std::vector<ncvar_t *> &ncvar_crd,
+  int dim_rows, int dim_cols, int nbr_rows, int nbr_cols) :
+  wxGridTableBase(),
+  m_ncvar(ncvar),
+  m_ncvar_crd(ncvar_crd),
+  m_dim_rows(dim_rows),
+  m_dim_cols(dim_cols),
+  m_nbr_rows(nbr_rows),
+  m_nbr_cols(nbr_cols),
+  m_idx_buf(0),
+  m_format(ncvar->m_nc_type),
+  m_mmap(NULL),
+  m_mmap_var(NULL),
+  m_format_unpack(NC_DOUBLE),
+  m_tiles(NULL)
+{
+  m_format_crd.reserve(ncvar_crd.size());
+  for (size_t idx_dmn = 0; idx_dmn < ncvar_crd.size(); idx_dmn++)
+  {
+    m_format_crd.push_back(ncformat_t(ncvar_crd[idx_dmn] != NULL ? ncvar_crd[idx_dmn]->m_nc_type : NC_NAT));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridTableLayers::GetValue
+//only called by the grid for cells being painted
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString wxGridTableLayers::GetValue(int row, int col)
+{
+  if (m_pack.is_unpacked())
+  {
+    return GetValueUnpack(row, col);
+  }
+  if (m_mmap_var != NULL)
+  {
+    m_str.clear();
+    m_format.append(m_mmap->at(*m_mmap_var, m_stride.at(m_idx_buf, row, col)), 0, m_str);
+    return wxString(m_str.c_str(), m_str.size());
+  }
+  if (m_tiles != NULL)
+  {
+    size_t idx;
+    const void *buf = m_tiles->at(row, col, idx);
+    if (buf == NULL)
+    {
+      return wxEmptyString;
+    }
+    m_str.clear();
+    m_format.append(buf, idx, m_str);
+    return wxString(m_str.c_str(), m_str.size());
+  }
+  if (m_ncvar->m_buf == NULL)
+  {
+    return wxEmptyString;
+  }
+  m_str.clear();
+  m_format.append(m_ncvar->m_buf, m_stride.at(m_idx_buf, row, col), m_str);
+  return wxString(m_str.c_str(), m_str.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridTableLayers::GetValueUnpack
+//value of a packed variable; a mapped element is copied in native byte order first
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString wxGridTableLayers::GetValueUnpack(int row, int col)
+{
+  unsigned long long elem; // one stored element (mapped)
+  double val; // one unpacked element
+  const void *buf;
+  size_t idx;
+  if (m_mmap_var != NULL)
+  {
+    nc_copy_be(&elem, m_mmap->at(*m_mmap_var, m_stride.at(m_idx_buf, row, col)), 1, nc_type_size(m_mmap_var->m_nc_type));
+    buf = &elem;
+    idx = 0;
+  }
+  else if (m_tiles != NULL)
+  {
+    if ((buf = m_tiles->at(row, col, idx)) == NULL)
+    {
+      return wxEmptyString;
+    }
+  }
+  else if (m_ncvar->m_buf != NULL)
+  {
+    buf = m_ncvar->m_buf;
+    idx = m_stride.at(m_idx_buf, row, col);
+  }
+  else
+  {
+    return wxEmptyString;
+  }
+  if (!nc_unpack_at(m_ncvar->m_nc_type, buf, idx, m_pack, &val))
+  {
+    return wxT("_");
+  }
+  m_str.clear();
+  m_format_unpack.append(&val, 0, m_str);
+  return wxString(m_str.c_str(), m_str.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridTableLayers::GetColLabelValue
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString wxGridTableLayers::GetColLabelValue(int col)
+{
+  //columns not defined
+  if (m_dim_cols == -1)
+  {
+    assert(m_nbr_cols == 1);
+    return wxString::Format(wxT("%d"), 1);
+  }
+  //coordinate variable exists
+  if (m_ncvar_crd[m_dim_cols] != NULL && m_ncvar_crd[m_dim_cols]->m_buf != NULL)
+  {
+    m_str.clear();
+    m_format_crd[m_dim_cols].append(m_ncvar_crd[m_dim_cols]->m_buf, col, m_str);
+    return wxString(m_str.c_str(), m_str.size());
+  }
+  return wxString::Format(wxT("%d"), col + 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridTableLayers::GetRowLabelValue
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString wxGridTableLayers::GetRowLabelValue(int row)
+{
+  //rows not defined
+  if (m_dim_rows == -1)
+  {
+    return wxString::Format(wxT("%d"), 1);
+  }
+  //coordinate variable exists
+  if (m_ncvar_crd[m_dim_rows] != NULL && m_ncvar_crd[m_dim_rows]->m_buf != NULL)
+  {
+    m_str.clear();
+    m_format_crd[m_dim_rows].append(m_ncvar_crd[m_dim_rows]->m_buf, row, m_str);
+    return wxString(m_str.c_str(), m_str.size());
+  }
+  return wxString::Format(wxT("%d"), row + 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxGridLayers::GetFormat
+//Provide sprintf() format string for specified netCDF type
+//Based on NCO utilities
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxString wxGridLayers::GetFormat(const nc_type typ)
+{
+  const char fmt_NC_FLOAT[] = "%g";
+  const char fmt_NC_DOUBLE[] = "%.12g";
+  const char fmt_NC_INT[] = "%i";
+  const char fmt_NC_SHORT[] = "%hi";
+  const char fmt_NC_CHAR[] = "%c";
+  const char fmt_NC_BYTE[] = "%hhi";
+  const char fmt_NC_UBYTE[] = "%hhu";
+  const char fmt_NC_USHORT[] = "%hu";
+  const char fmt_NC_UINT[] = "%u";
+  const char fmt_NC_INT64[] = "%lli";
+  const char fmt_NC_UINT64[] = "%llu";
+  const char fmt_NC_STRING[] = "%s";
+  switch (typ)
+  {
+  case NC_FLOAT:
+    return  wxString::FromAscii(fmt_NC_FLOAT);
+  case NC_DOUBLE:
+    return wxString::FromAscii(fmt_NC_DOUBLE);
+  case NC_INT:
+    return wxString::FromAscii(fmt_NC_INT);
+  case NC_SHORT:
+    return wxString::FromAscii(fmt_NC_SHORT);
+  case NC_CHAR:
+    return wxString::FromAscii(fmt_NC_CHAR);
+  case NC_BYTE:
+    return wxString::FromAscii(fmt_NC_BYTE);
+  case NC_UBYTE:
+    return wxString::FromAscii(fmt_NC_UBYTE);
+  case NC_USHORT:
+    return wxString::FromAscii(fmt_NC_USHORT);
+  case NC_UINT:
+    return wxString::FromAscii(fmt_NC_UINT);
+  case NC_INT64:
+    return wxString::FromAscii(fmt_NC_INT64);
+  case NC_UINT64:
+    return wxString::FromAscii(fmt_NC_UINT64);
+  case NC_STRING:
+    return wxString::FromAscii(fmt_NC_STRING);
+  }
+  return wxString::FromAscii("");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnItemMenu
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnItemMenu(wxTreeEvent& event)
+{
+  wxMenu menu;
+  wxTreeItemId item_id = event.GetItem();
+  this->SetFocusedItem(item_id);
+  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
+  if (item_data == NULL || item_data->m_kind != wxItemData::Variable)
+  {
+    return;
+  }
+  menu.Append(ID_TREE_LOAD_ITEM, wxT("&Show"));
+  menu.Append(ID_TREE_DIMENSIONS, wxT("&Dimensions..."));
+  PopupMenu(&menu, event.GetPoint());
+  event.Skip();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnLoadItem
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnLoadItem(wxCommandEvent& WXUNUSED(event))
+{
+  wxTreeItemId item_id = this->GetFocusedItem();
+  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
+  assert(item_data->m_kind == wxItemData::Variable);
+  ShowVariable(item_data);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnDimensions
+//choose the dimensions of rows and columns of a variable and show it; views already open keep 
+//their dimensions
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnDimensions(wxCommandEvent& WXUNUSED(event))
+{
+  wxTreeItemId item_id = this->GetFocusedItem();
+  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
+  assert(item_data->m_kind == wxItemData::Variable);
+  wxDialogDimensions dialog(this, item_data->m_ncvar, *item_data->GetGridPolicy());
+  if (dialog.ShowModal() != wxID_OK)
+  {
+    return;
+  }
+  item_data->GetGridPolicy()->set(item_data->m_ncvar->m_ncdim.size(), dialog.GetRows(), dialog.GetCols());
+  ShowVariable(item_data);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxTreeCtrlExplorer::OnUpdateDimensions
+//variables with two or more dimensions
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxTreeCtrlExplorer::OnUpdateDimensions(wxUpdateUIEvent& event)
+{
+  wxItemData *item_data = (wxItemData *)GetItemData(this->GetFocusedItem());
+  event.Enable(item_data != NULL && item_data->m_kind == wxItemData::Variable && item_data->m_ncvar->m_ncdim.size() >= 2);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogDimensions::wxDialogDimensions
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxBEGIN_EVENT_TABLE(wxDialogDimensions, wxDialog)
+EVT_CHOICE(ID_DIMENSIONS_ROWS, wxDialogDimensions::OnChoice)
+EVT_CHOICE(ID_DIMENSIONS_COLS, wxDialogDimensions::OnChoice)
+EVT_UPDATE_UI(wxID_OK, wxDialogDimensions::OnUpdateOK)
+wxEND_EVENT_TABLE()
+
+wxDialogDimensions::wxDialogDimensions(wxWindow *parent, const ncvar_t *ncvar, const grid_policy_t &grid_policy) :
+  wxDialog(parent, wxID_ANY, wxString::Format(wxT("Dimensions of %s"), ncvar->m_name)),
+  m_ncvar(ncvar)
+{
+  wxArrayString vec_str;
+  for (size_t idx_dmn = 0; idx_dmn < ncvar->m_ncdim.size(); idx_dmn++)
+  {
+    vec_str.Add(wxString::Format(wxT("%s (%lu)"), ncvar->m_ncdim[idx_dmn].m_name, 
+      static_cast<unsigned long>(ncvar->m_ncdim[idx_dmn].m_size)));
+  }
+  m_choice_rows = new wxChoice(this, ID_DIMENSIONS_ROWS, wxDefaultPosition, wxDefaultSize, vec_str);
+  m_choice_cols = new wxChoice(this, ID_DIMENSIONS_COLS, wxDefaultPosition, wxDefaultSize, vec_str);
+  m_choice_rows->SetSelection(grid_policy.m_dim_rows);
+  m_choice_cols->SetSelection(grid_policy.m_dim_cols);
+  m_text_layers = new wxStaticText(this, ID_DIMENSIONS_LAYERS, wxEmptyString);
+
+  wxFlexGridSizer *sizer_dim = new wxFlexGridSizer(2, 5, 5);
+  sizer_dim->Add(new wxStaticText(this, wxID_ANY, wxT("Rows")), 0, wxALIGN_CENTER_VERTICAL);
+  sizer_dim->Add(m_choice_rows, 1, wxEXPAND);
+  sizer_dim->Add(new wxStaticText(this, wxID_ANY, wxT("Columns")), 0, wxALIGN_CENTER_VERTICAL);
+  sizer_dim->Add(m_choice_cols, 1, wxEXPAND);
+  sizer_dim->Add(new wxStaticText(this, wxID_ANY, wxT("Layers")), 0, wxALIGN_CENTER_VERTICAL);
+  sizer_dim->Add(m_text_layers, 1, wxEXPAND);
+  sizer_dim->AddGrowableCol(1);
+  wxBoxSizer *sizer = new wxBoxSizer(wxVERTICAL);
+  sizer->Add(sizer_dim, 1, wxEXPAND | wxALL, 10);
+  sizer->Add(CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 10);
+  UpdateLayers();
+  SetSizerAndFit(sizer);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogDimensions::UpdateLayers
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxDialogDimensions::UpdateLayers()
+{
+  grid_policy_t grid_policy(m_ncvar->m_ncdim);
+  grid_policy.set(m_ncvar->m_ncdim.size(), GetRows(), GetCols());
+  wxString str;
+  for (size_t idx_dmn = 0; idx_dmn < grid_policy.m_dim_layers.size(); idx_dmn++)
+  {
+    str += (idx_dmn ? wxT(", ") : wxT("")) + wxString(m_ncvar->m_ncdim[grid_policy.m_dim_layers[idx_dmn]].m_name);
+  }
+  m_text_layers->SetLabel(str.IsEmpty() ? wxString(wxT("none")) : str);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogDimensions::OnChoice
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxDialogDimensions::OnChoice(wxCommandEvent& WXUNUSED(event))
+{
+  UpdateLayers();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogDimensions::OnUpdateOK
+//rows and columns are different dimensions
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxDialogDimensions::OnUpdateOK(wxUpdateUIEvent& event)
+{
+  event.Enable(GetRows() != GetCols());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogFind::wxDialogFind
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+wxBEGIN_EVENT_TABLE(wxDialogFind, wxDialog)
+EVT_UPDATE_UI(wxID_OK, wxDialogFind::OnUpdateOK)
+EVT_UPDATE_UI(ID_FIND_VAL, wxDialogFind::OnUpdateVal)
+EVT_UPDATE_UI(ID_FIND_VAL_MAX, wxDialogFind::OnUpdateValMax)
+wxEND_EVENT_TABLE()
+
+wxDialogFind::wxDialogFind(wxWindow *parent, const ncvar_t *ncvar, const ncfind_t &find) :
+  wxDialog(parent, wxID_ANY, wxString::Format(wxT("Find in %s"), ncvar->m_name))
+{
+  wxArrayString vec_op;
+  vec_op.Add(wxT("equal to"));
+  vec_op.Add(wxT("between"));
+  vec_op.Add(wxT("greater than"));
+  vec_op.Add(wxT("less than"));
+  vec_op.Add(wxT("NaN"));
+  m_choice_op = new wxChoice(this, ID_FIND_OP, wxDefaultPosition, wxDefaultSize, vec_op);
+  m_choice_op->SetSelection(find.m_op);
+  m_text_val = new wxTextCtrl(this, ID_FIND_VAL, wxString::Format(wxT("%.17g"), find.m_val));
+  m_text_val_max = new wxTextCtrl(this, ID_FIND_VAL_MAX, wxString::Format(wxT("%.17g"), find.m_val_max));
+
+  wxFlexGridSizer *sizer_find = new wxFlexGridSizer(2, 5, 5);
+  sizer_find->Add(new wxStaticText(this, wxID_ANY, wxT("Values")), 0, wxALIGN_CENTER_VERTICAL);
+  sizer_find->Add(m_choice_op, 1, wxEXPAND);
+  sizer_find->Add(new wxStaticText(this, wxID_ANY, wxT("Value")), 0, wxALIGN_CENTER_VERTICAL);
+  sizer_find->Add(m_text_val, 1, wxEXPAND);
+  sizer_find->Add(new wxStaticText(this, wxID_ANY, wxT("and")), 0, wxALIGN_CENTER_VERTICAL);
+  sizer_find->Add(m_text_val_max, 1, wxEXPAND);
+  sizer_find->AddGrowableCol(1);
+  wxBoxSizer *sizer = new wxBoxSizer(wxVERTICAL);
+  sizer->Add(sizer_find, 1, wxEXPAND | wxALL, 10);
+  sizer->Add(CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 10);
+  SetSizerAndFit(sizer);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogFind::GetFind
+//condition entered, false if a value needed is not a number
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool wxDialogFind::GetFind(ncfind_t &find) const
+{
+  find.m_op = m_choice_op->GetSelection();
+  if (find.m_op == nc_find_nan)
+  {
+    return true;
+  }
+  if (!m_text_val->GetValue().ToDouble(&find.m_val))
+  {
+    return false;
+  }
+  return find.m_op != nc_find_range || m_text_val_max->GetValue().ToDouble(&find.m_val_max);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogFind::OnUpdateOK
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxDialogFind::OnUpdateOK(wxUpdateUIEvent& event)
+{
+  ncfind_t find;
+  event.Enable(GetFind(find));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogFind::OnUpdateVal
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxDialogFind::OnUpdateVal(wxUpdateUIEvent& event)
+{
+  event.Enable(m_choice_op->GetSelection() != nc_find_nan);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//wxDialogFind::OnUpdateValMax
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void wxDialogFind::OnUpdateValMax(wxUpdateUIEvent& event)
+{
+  event.Enable(m_choice_op->GetSelection() == nc_find_range);
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//batch mode (--batch, --no-gui)
+//list the tree of files, or print a variable, a hyperslab or a layer to stdout, without the GUI;
+//uses the same iteration (ScanGroup), loading (LoadItem, LoadVariable) and formatting (ncformat_t) 
+//as the explorer, wxWidgets is not initialized
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool IsBatch(int argc, char **argv)
+{
+  for (int idx_arg = 1; idx_arg < argc; idx_arg++)
+  {
+    if (strcmp(argv[idx_arg], "--batch") == 0 || strcmp(argv[idx_arg], "--no-gui") == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//ParseIndexList
+//comma separated list of indices, "0,10,5"
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ParseIndexList(const wxString& str, std::vector<size_t> &list)
+{
+  std::string buf(str.mb_str());
+  const char *ptr = buf.c_str();
+  list.clear();
+  while (*ptr != '\0')
+  {
+    char *end;
+    unsigned long idx = strtoul(ptr, &end, 10);
+    if (end == ptr || (*end != ',' && *end != '\0'))
+    {
+      return false;
+    }
+    list.push_back(idx);
+    ptr = (*end == ',') ? end + 1 : end;
+  }
+  return !list.empty();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//BatchList
+//print groups and variables of a group and its sub-groups
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int BatchList(const wxString& file_name, const wxString& grp_nm_fll, int level)
 {
-  char var_nm[NC_MAX_NAME + 1]; // variable name 
-  char dmn_nm_var[NC_MAX_NAME + 1]; //dimension name
   int nc_id;
   int grp_id;
-  int var_id;
-  nc_type var_type;
-  int nbr_dmn;
-  int var_dimid[NC_MAX_VAR_DIMS];
-  size_t dmn_sz[NC_MAX_VAR_DIMS];
-  size_t buf_sz; // variable size
-  int fl_fmt;
+  char typ_nm[NC_MAX_NAME + 1];
+  ncgrp_t grp;
+  wxString indent(' ', 2 * level);
+  int status;
 
-  assert(item_data->m_kind == wxItemData::Variable);
+  if ((status = OpenGroup(file_name.mb_str(), grp_nm_fll.mb_str(), &nc_id, &grp_id)) != NC_NOERR)
+  {
+    return status;
+  }
+  if ((status = wxFrameExplorer::ScanGroup(grp_id, grp)) != NC_NOERR)
+  {
+    return status;
+  }
 
-  if (nc_open(item_data->m_file_name, NC_NOWRITE, &nc_id) != NC_NOERR)
+  for (size_t idx_var = 0; idx_var < grp.m_ncvar.size(); idx_var++)
   {
+    ncvar_t *ncvar = grp.m_ncvar[idx_var];
+    if (nc_inq_type(nc_id, ncvar->m_nc_type, typ_nm, NULL) != NC_NOERR)
+    {
+      typ_nm[0] = '\0';
+    }
+    wxString str = wxString::Format("%s  %s %s", indent, typ_nm, ncvar->m_name);
+    if (ncvar->m_ncdim.size())
+    {
+      str += "(";
+      for (size_t idx_dmn = 0; idx_dmn < ncvar->m_ncdim.size(); idx_dmn++)
+      {
+        str += wxString::Format("%s%s=%lu", idx_dmn ? ", " : "", ncvar->m_ncdim[idx_dmn].m_name,
+          static_cast<unsigned long>(ncvar->m_ncdim[idx_dmn].m_size));
+      }
+      str += ")";
+    }
+    str += " " + GetStorageInfo(ncvar);
+    printf("%s\n", static_cast<const char*>(str.mb_str()));
+  }
 
+  for (size_t idx_grp = 0; idx_grp < grp.m_grp_nm.size(); idx_grp++)
+  {
+    wxString grp_nm_fll_sub(grp_nm_fll);
+    if (grp_nm_fll_sub != "/")
+    {
+      grp_nm_fll_sub += "/";
+    }
+    grp_nm_fll_sub += grp.m_grp_nm[idx_grp];
+    printf("%s  %s/\n", static_cast<const char*>(indent.mb_str()), grp.m_grp_nm[idx_grp].c_str());
+    if ((status = BatchList(file_name, grp_nm_fll_sub, level + 1)) != NC_NOERR)
+    {
+      return status;
+    }
   }
+  return NC_NOERR;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//BatchDump
+//print hyperslab start/count of variable item_data; rows of the last dimension are printed one
+//per line, labeled with the coordinate variable of the previous dimension (or 1-based index);
+//the hyperslab is streamed from file (StreamLoad), values of a chunk are formatted in parallel and 
+//written while the next chunk is read
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  //need a file format inquiry, since nc_inq_grp_full_ncid does not handle netCDF3 cases
-  if (nc_inq_format(nc_id, &fl_fmt) != NC_NOERR)
+int BatchDump(wxItemData *item_data, const std::vector<size_t> &start, const std::vector<size_t> &count)
+{
+  ncvar_t *ncvar = item_data->m_ncvar;
+  size_t nbr_dmn = ncvar->m_ncdim.size();
+  size_t nbr_col = nbr_dmn ? count[nbr_dmn - 1] : 1;
+  size_t buf_sz = 1; // number of elements of hyperslab
+  std::vector<size_t> idx(nbr_dmn, 0); // index in hyperslab of first element of a printed row
+
+  //coordinate variables, for labels
+  int status = wxTreeCtrlExplorer::LoadItem(item_data, false);
+  if (status != NC_NOERR)
   {
+    return status;
+  }
+  ncvar_t *ncvar_row = (nbr_dmn > 1) ? item_data->m_ncvar_crd[nbr_dmn - 2] : NULL;
+  ncvar_t *ncvar_col = nbr_dmn ? item_data->m_ncvar_crd[nbr_dmn - 1] : NULL;
 
+  for (size_t idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
+  {
+    buf_sz *= count[idx_dmn];
+  }
+  ncformat_t fmt(ncvar->m_nc_type);
+  ncformat_t fmt_row(ncvar_row ? ncvar_row->m_nc_type : NC_NAT);
+  ncformat_t fmt_col(ncvar_col ? ncvar_col->m_nc_type : NC_NAT);
+  ncarena_t arena; // values of chunk, memory reused for all chunks
+  std::vector<ncarena_t> parts; // values formatted by each thread
+  std::string out; // text of chunk
+
+  //header, column labels (written per chunk of labels, a one-dimensional variable has one column per element)
+  if (nbr_dmn)
+  {
+    for (size_t idx_col = 0; idx_col < nbr_col; idx_col++)
+    {
+      size_t idx_crd = start[nbr_dmn - 1] + idx_col;
+      out += "\t";
+      if (ncvar_col != NULL && ncvar_col->m_buf != NULL)
+      {
+        fmt_col.append(ncvar_col->m_buf, idx_crd, out);
+      }
+      else
+      {
+        char str[nc_format_max];
+        out.append(str, nc_format_uint(idx_crd + 1, str));
+      }
+      if (out.size() > load_chunk_size)
+      {
+        fwrite(out.data(), 1, out.size(), stdout);
+        out.clear();
+      }
+    }
+    out += "\n";
+    fwrite(out.data(), 1, out.size(), stdout);
   }
 
-  if (fl_fmt == NC_FORMAT_NETCDF4 || fl_fmt == NC_FORMAT_NETCDF4_CLASSIC)
+  ncload_t load(item_data);
+  load.m_start = start;
+  load.m_count = count;
+  return StreamLoad(&load, NULL, [&](const void *buf, size_t idx_buf, size_t nbr_elm) -> bool
   {
-    // obtain group ID for netCDF4 files
-    if (nc_inq_grp_full_ncid(nc_id, item_data->m_grp_nm_fll, &grp_id) != NC_NOERR)
+    //format values of chunk (in parallel)
+    arena.clear();
+    nc_format_parallel(fmt, buf, 0, nbr_elm, arena, parts);
+
+    //one line per row of the last dimension; a one-dimensional variable is one line, continued by 
+    //each chunk
+    out.clear();
+    size_t nbr_col_chunk = (nbr_dmn == 1) ? nbr_elm : nbr_col;
+    for (size_t idx_elm = 0; idx_elm < nbr_elm; idx_elm += nbr_col_chunk)
     {
+      //new layer (index of the dimensions before rows changed)
+      if (nbr_dmn > 2 && idx[nbr_dmn - 2] == 0)
+      {
+        out += "\n//(";
+        for (size_t idx_dmn = 0; idx_dmn < nbr_dmn - 2; idx_dmn++)
+        {
+          char str[nc_format_max];
+          out.append(str, nc_format_uint(start[idx_dmn] + idx[idx_dmn], str));
+          out += ",";
+        }
+        out += ":,:)\n";
+      }
+      if (nbr_dmn > 1)
+      {
+        size_t idx_crd = start[nbr_dmn - 2] + idx[nbr_dmn - 2];
+        if (ncvar_row != NULL && ncvar_row->m_buf != NULL)
+        {
+          fmt_row.append(ncvar_row->m_buf, idx_crd, out);
+        }
+        else
+        {
+          char str[nc_format_max];
+          out.append(str, nc_format_uint(idx_crd + 1, str));
+        }
+      }
+      for (size_t idx_col = 0; idx_col < nbr_col_chunk; idx_col++)
+      {
+        out += "\t";
+        out.append(arena.str(idx_elm + idx_col), arena.length(idx_elm + idx_col));
+      }
+      if (nbr_dmn != 1 || idx_buf + nbr_elm == buf_sz)
+      {
+        out += "\n";
+      }
 
+      //next row index (odometer over all dimensions but the last)
+      for (int idx_dmn = static_cast<int>(nbr_dmn) - 2; idx_dmn >= 0; idx_dmn--)
+      {
+        if (++idx[idx_dmn] < count[idx_dmn])
+        {
+          break;
+        }
+        idx[idx_dmn] = 0;
+      }
     }
-  }
-  else
+    fwrite(out.data(), 1, out.size(), stdout);
+    return true;
+  });
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//BatchStats
+//print statistics of a hyperslab of a variable, streamed from file
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int BatchStats(wxItemData *item_data, const std::vector<size_t> &start, const std::vector<size_t> &count)
+{
+  ncload_t load(item_data);
+  ncstats_t stats;
+  load.m_start = start;
+  load.m_count = count;
+  if (StatsLoad(&load, item_data->m_ncvar->m_fill, item_data->m_pack, stats) != NC_NOERR)
   {
-    //make the group ID the file ID for netCDF3 cases
-    grp_id = nc_id;
+    return load.m_status;
   }
+  printf("%s", static_cast<const char*>(FormatStatsHeader().mb_str()));
+  printf("%s", static_cast<const char*>(FormatStats(item_data->m_item_nm, stats).mb_str()));
+  return NC_NOERR;
+}
 
-  //all hunky dory from here 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//BatchMain
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  // get variable ID
-  if (nc_inq_varid(grp_id, item_data->m_item_nm, &var_id) != NC_NOERR)
+int BatchMain(int argc, char **argv)
+{
+  wxMessageOutput::Set(new wxMessageOutputStderr);
+  wxCmdLineParser parser(argc, argv);
+  parser.AddSwitch("", "batch", "run without GUI");
+  parser.AddSwitch("", "no-gui", "run without GUI");
+  parser.AddSwitch("h", "help", "show this help message", wxCMD_LINE_OPTION_HELP);
+  parser.AddOption("v", "var", "variable to print, full path (/group/variable)");
+  parser.AddOption("s", "start", "hyperslab start, comma separated indices");
+  parser.AddOption("n", "count", "hyperslab count, comma separated");
+  parser.AddOption("l", "layer", "indices of the layer dimensions of layer to print, comma separated");
+  parser.AddSwitch("", "stats", "print statistics (min, max, mean, stddev, NaN and _FillValue count) instead of values");
+  parser.AddParam("input files", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE);
+  if (parser.Parse() != 0)
   {
-
+    return 1;
   }
 
-  if (nc_inq_var(grp_id, var_id, var_nm, &var_type, &nbr_dmn, var_dimid, (int *)NULL) != NC_NOERR)
+  wxString var_path;
+  wxString str;
+  std::vector<size_t> start;
+  std::vector<size_t> count;
+  std::vector<size_t> layer;
+  bool has_var = parser.Found("var", &var_path);
+  bool stats = parser.Found("stats");
+  if ((parser.Found("start", &str) && !ParseIndexList(str, start)) ||
+    (parser.Found("count", &str) && !ParseIndexList(str, count)) ||
+    (parser.Found("layer", &str) && !ParseIndexList(str, layer)))
   {
-
+    fprintf(stderr, "invalid index list\n");
+    return 1;
   }
 
-  //detect coordinate variables 
-  for (int idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
+  int ret = 0;
+  for (size_t idx_fil = 0; idx_fil < parser.GetParamCount(); idx_fil++)
   {
-    int has_crd_var = 0;
+    wxString file_name = parser.GetParam(idx_fil);
 
-    //dimensions belong to groups
-    if (nc_inq_dim(grp_id, var_dimid[idx_dmn], dmn_nm_var, &dmn_sz[idx_dmn]) != NC_NOERR)
+    //list
+    if (!has_var)
     {
-
+      printf("%s\n", static_cast<const char*>(file_name.mb_str()));
+      int status = BatchList(file_name, "/", 0);
+      if (status != NC_NOERR)
+      {
+        fprintf(stderr, "%s: %s\n", static_cast<const char*>(file_name.mb_str()), nc_strerror(status));
+        ret = 1;
+      }
+      continue;
     }
 
-    /////////////////////////////////////////////////////////////////////////////////////////////////////
-    //look up possible coordinate variables
-    //traverse all variables in group and match a variable name 
-    /////////////////////////////////////////////////////////////////////////////////////////////////////
-
-    for (size_t idx_var = 0; idx_var < item_data->m_item_data_prn->m_var_nms.size(); idx_var++)
+    //find variable, as items in the tree
+    wxString grp_nm_fll = var_path.BeforeLast('/');
+    wxString var_nm = var_path.AfterLast('/');
+    if (grp_nm_fll.empty())
     {
-      wxString str_var_nm(item_data->m_item_data_prn->m_var_nms[idx_var]);
-
-      if (str_var_nm == wxString(dmn_nm_var))
+      grp_nm_fll = "/";
+    }
+    int nc_id;
+    int grp_id;
+    ncgrp_t grp;
+    if (OpenGroup(file_name.mb_str(), grp_nm_fll.mb_str(), &nc_id, &grp_id) != NC_NOERR || wxFrameExplorer::ScanGroup(grp_id, grp) != NC_NOERR)
+    {
+      fprintf(stderr, "cannot open %s%s\n", static_cast<const char*>(file_name.mb_str()), static_cast<const char*>(grp_nm_fll.mb_str()));
+      ret = 1;
+      continue;
+    }
+    wxItemData item_data_grp(wxItemData::Group, file_name.mb_str(), grp.m_grp_nm_fll.c_str(), grp_nm_fll.mb_str(), (wxItemData*)NULL,
+      (ncvar_t*)NULL, (grid_policy_t*)NULL);
+    wxItemData *item_data = NULL;
+    for (size_t idx_var = 0; idx_var < grp.m_ncvar.size(); idx_var++)
+    {
+      item_data_grp.m_var_ids[grp.m_ncvar[idx_var]->m_name] = static_cast<int>(idx_var);
+      if (item_data == NULL && var_nm == grp.m_ncvar[idx_var]->m_name)
       {
-        has_crd_var = 1;
-        break;
+        item_data = new wxItemData(wxItemData::Variable, file_name.mb_str(), grp.m_grp_nm_fll.c_str(), var_nm.mb_str(), &item_data_grp,
+          grp.m_ncvar[idx_var], new grid_policy_t(grp.m_ncvar[idx_var]->m_ncdim));
+        grp.m_ncvar[idx_var] = NULL;
       }
     }
-
-    /////////////////////////////////////////////////////////////////////////////////////////////////////
-    //a coordinate variable was found
-    //since the lookup was only in the same group, get the variable information on this group 
-    /////////////////////////////////////////////////////////////////////////////////////////////////////
-
-    if (has_crd_var)
+    if (item_data == NULL)
     {
-      int crd_var_id;
-      char crd_var_nm[NC_MAX_NAME + 1];
-      int crd_nbr_dmn;
-      int crd_var_dimid[NC_MAX_VAR_DIMS];
-      size_t crd_dmn_sz[NC_MAX_VAR_DIMS];
-      nc_type crd_var_type = NC_NAT;
+      fprintf(stderr, "variable %s not found in %s\n", static_cast<const char*>(var_path.mb_str()), static_cast<const char*>(file_name.mb_str()));
+      ret = 1;
+      continue;
+    }
 
-      // get coordinate variable ID (using the dimension name, since there was a match to a variable)
-      if (nc_inq_varid(grp_id, dmn_nm_var, &crd_var_id) != NC_NOERR)
+    //hyperslab: whole variable, start/count, or one layer
+    const std::vector<ncdim_t> &ncdim = item_data->m_ncvar->m_ncdim;
+    std::vector<size_t> start_var(ncdim.size(), 0);
+    std::vector<size_t> count_var;
+    for (size_t idx_dmn = 0; idx_dmn < ncdim.size(); idx_dmn++)
+    {
+      count_var.push_back(ncdim[idx_dmn].m_size);
+    }
+    if (!layer.empty())
+    {
+      const std::vector<int> &dim_layers = item_data->GetGridPolicy()->m_dim_layers;
+      for (size_t idx_dmn = 0; idx_dmn < layer.size() && idx_dmn < dim_layers.size(); idx_dmn++)
       {
-
+        start_var[dim_layers[idx_dmn]] = layer[idx_dmn];
+        count_var[dim_layers[idx_dmn]] = 1;
       }
-
-      if (nc_inq_var(grp_id, crd_var_id, crd_var_nm, &crd_var_type, &crd_nbr_dmn, crd_var_dimid, (int *)NULL) != NC_NOERR)
+    }
+    for (size_t idx_dmn = 0; idx_dmn < start.size() && idx_dmn < ncdim.size(); idx_dmn++)
+    {
+      start_var[idx_dmn] = start[idx_dmn];
+      count_var[idx_dmn] = ncdim[idx_dmn].m_size - std::min(start[idx_dmn], ncdim[idx_dmn].m_size);
+    }
+    for (size_t idx_dmn = 0; idx_dmn < count.size() && idx_dmn < ncdim.size(); idx_dmn++)
+    {
+      count_var[idx_dmn] = count[idx_dmn];
+    }
+    bool valid = true;
+    for (size_t idx_dmn = 0; idx_dmn < ncdim.size(); idx_dmn++)
+    {
+      if (start_var[idx_dmn] + count_var[idx_dmn] > ncdim[idx_dmn].m_size || count_var[idx_dmn] == 0)
       {
-
+        valid = false;
       }
+    }
 
-      assert(wxString(crd_var_nm) == wxString(dmn_nm_var));
-
-      if (crd_nbr_dmn == 1)
-      {
-        //get size
-        if (nc_inq_dim(grp_id, crd_var_dimid[0], (char *)NULL, &crd_dmn_sz[0]) != NC_NOERR)
-        {
-
-        }
-
-        //store dimension 
-        std::vector<ncdim_t> ncdim; //dimensions for each variable 
-        ncdim_t dim(dmn_nm_var, crd_dmn_sz[0]);
-        ncdim.push_back(dim);
-
-        //store a ncvar_t
-        ncvar_t *ncvar = new ncvar_t(crd_var_nm, crd_var_type, ncdim);
-
-        //allocate, load 
-        ncvar->store(LoadVariable(grp_id, crd_var_id, crd_var_type, crd_dmn_sz[0]));
-
-        //and store in tree 
-        item_data->m_ncvar_crd.push_back(ncvar);
-      }
+    int status = NC_EINVALCOORDS;
+    if (valid)
+    {
+      status = stats ? BatchStats(item_data, start_var, count_var) : BatchDump(item_data, start_var, count_var);
     }
-    else
+    if (status != NC_NOERR)
     {
-      item_data->m_ncvar_crd.push_back(NULL); //no coordinate variable for this dimension
+      fprintf(stderr, "%s: %s\n", static_cast<const char*>(var_path.mb_str()), nc_strerror(status));
+      ret = 1;
     }
+    delete item_data;
   }
 
-  //define buffer size
-  buf_sz = 1;
-  for (int idx_dmn = 0; idx_dmn < nbr_dmn; idx_dmn++)
-  {
-    buf_sz *= dmn_sz[idx_dmn];
-  }
+  nc_pool.close_all();
+  return ret;
+}
 
-  //allocate buffer and store in item data 
-  item_data->m_ncvar->store(LoadVariable(grp_id, var_id, var_type, buf_sz));
+#ifdef BENCH_EXPLORER
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//bench_explorer
+//same source built with -DBENCH_EXPLORER (Makefile.am target bench_explorer); generates synthetic
+//netCDF-3 and netCDF-4 files and times opening and iteration (as the open worker), LoadItem, 
+//LoadVariable (and the mapped read of netCDF-3 files) for each type, formatting of one layer (as 
+//the grid table), statistics, search, unpacking, rendering and pyramid of one layer (as the image view),
+//copy and transpose of one layer (as views of chosen dimensions); results are written as CSV, one
+//line per case: format,type,rank,size,chunk,depth,case,ms,count,rate
+//count is bytes read for loads, cells for formatting, elements for statistics, search, unpacking, pyramid
+//and layer copies and pixels for rendering,
+//rate is count per second
+//memory used (interned names) is written apart, to standard error, one line per case: 
+//format,case,bytes
+/////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (nc_close(nc_id) != NC_NOERR)
-  {
+const nc_type bench_type[] = { NC_BYTE, NC_CHAR, NC_SHORT, NC_INT, NC_FLOAT, NC_DOUBLE, 
+  NC_UBYTE, NC_USHORT, NC_UINT, NC_INT64, NC_UINT64 };
+const char *bench_type_nm[] = { "byte", "char", "short", "int", "float", "double", 
+  "ubyte", "ushort", "uint", "int64", "uint64" };
+const int bench_nbr_type = 11;
+const int bench_nbr_type_nc3 = 6; //first types are netCDF-3 types
 
+class bench_t
+{
+public:
+  bench_t() :
+    m_size(1024 * 1024),
+    m_rank(3),
+    m_chunk(0),
+    m_depth(0),
+    m_repeat(3),
+    m_out(stdout),
+    m_out_mem(stderr)
+  {
   }
-}
+  size_t m_size; // elements per variable
+  int m_rank; // dimensions per variable
+  size_t m_chunk; // (netCDF-4) chunk size of row and column dimensions, 0 for contiguous
+  int m_depth; // (netCDF-4) variables are in a group nested this deep
+  int m_repeat; // times each case is run (average)
+  std::vector<int> m_type; // indices in bench_type of types to generate
+  std::vector<size_t> m_dim; // dimension sizes
+  FILE *m_out; // results
+  FILE *m_out_mem; // memory results
+  void Result(const char *fmt, int idx_typ, const char *bench_case, double ms, double count)
+  {
+    fprintf(m_out, "%s,%s,%d,%lu,%lu,%d,%s,%.3f,%.0f,%.0f\n", fmt, idx_typ < 0 ? "" : bench_type_nm[idx_typ], m_rank,
+      static_cast<unsigned long>(m_size), static_cast<unsigned long>(m_chunk), m_depth, bench_case, ms, count,
+      ms > 0 ? count * 1000.0 / ms : 0.0);
+    fflush(m_out);
+  }
+  void Memory(const char *fmt, const char *bench_case, size_t bytes)
+  {
+    fprintf(m_out_mem, "%s,%s,%lu\n", fmt, bench_case, static_cast<unsigned long>(bytes));
+  }
+};
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::LoadVariable
+//BenchCreate
+//write a file with one variable per type (named as the type) in group /g1/g2/.. of depth m_depth, 
+//with float coordinate variables; values are written in slabs along the first dimension
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void* wxTreeCtrlExplorer::LoadVariable(const int nc_id, const int var_id, const nc_type var_type, size_t buf_sz)
+int BenchCreate(const bench_t &bench, const char *file_name, bool nc4, wxString &grp_nm_fll)
 {
-  void *buf = NULL;
-  switch (var_type)
+  int status;
+  int nc_id;
+  int grp_id;
+  int dim_id[NC_MAX_VAR_DIMS];
+  std::vector<int> var_id;
+  char dmn_nm[NC_MAX_NAME + 1];
+
+  if ((status = nc_create(file_name, NC_CLOBBER | (nc4 ? NC_NETCDF4 : NC_64BIT_OFFSET), &nc_id)) != NC_NOERR)
   {
-  case NC_FLOAT:
-    buf = malloc(buf_sz * sizeof(float));
-    if (nc_get_var_float(nc_id, var_id, static_cast<float *>(buf)) != NC_NOERR)
-    {
-    }
-    break;
-  case NC_DOUBLE:
-    buf = malloc(buf_sz * sizeof(double));
-    if (nc_get_var_double(nc_id, var_id, static_cast<double *>(buf)) != NC_NOERR)
-    {
-    }
-    break;
-  case NC_INT:
-    buf = malloc(buf_sz * sizeof(int));
-    if (nc_get_var_int(nc_id, var_id, static_cast<int *>(buf)) != NC_NOERR)
-    {
-    }
-    break;
-  case NC_SHORT:
-    buf = malloc(buf_sz * sizeof(short));
-    if (nc_get_var_short(nc_id, var_id, static_cast<short *>(buf)) != NC_NOERR)
+    return status;
+  }
+  grp_id = nc_id;
+  grp_nm_fll = "/";
+  for (int idx_grp = 0; nc4 && idx_grp < bench.m_depth; idx_grp++)
+  {
+    wxString grp_nm = wxString::Format("g%d", idx_grp + 1);
+    if ((status = nc_def_grp(grp_id, grp_nm.mb_str(), &grp_id)) != NC_NOERR)
     {
+      nc_close(nc_id);
+      return status;
     }
-    break;
-  case NC_CHAR:
-    buf = malloc(buf_sz * sizeof(char));
-    if (nc_get_var_text(nc_id, var_id, static_cast<char *>(buf)) != NC_NOERR)
+    grp_nm_fll += (idx_grp ? "/" : "") + grp_nm;
+  }
+
+  for (int idx_dmn = 0; idx_dmn < bench.m_rank; idx_dmn++)
+  {
+    int crd_id;
+    sprintf(dmn_nm, "d%d", idx_dmn);
+    if ((status = nc_def_dim(grp_id, dmn_nm, bench.m_dim[idx_dmn], &dim_id[idx_dmn])) != NC_NOERR ||
+      (status = nc_def_var(grp_id, dmn_nm, NC_FLOAT, 1, &dim_id[idx_dmn], &crd_id)) != NC_NOERR)
     {
+      nc_close(nc_id);
+      return status;
     }
-    break;
-  case NC_BYTE:
-    buf = malloc(buf_sz * sizeof(signed char));
-    if (nc_get_var_schar(nc_id, var_id, static_cast<signed char *>(buf)) != NC_NOERR)
+  }
+
+  for (size_t idx = 0; idx < bench.m_type.size(); idx++)
+  {
+    int idx_typ = bench.m_type[idx];
+    int id = -1;
+    if (nc4 || idx_typ < bench_nbr_type_nc3)
     {
+      if ((status = nc_def_var(grp_id, bench_type_nm[idx_typ], bench_type[idx_typ], bench.m_rank, dim_id, &id)) != NC_NOERR)
+      {
+        nc_close(nc_id);
+        return status;
+      }
+      if (nc4 && bench.m_chunk > 0 && bench.m_rank > 0)
+      {
+        size_t chunk[NC_MAX_VAR_DIMS];
+        for (int idx_dmn = 0; idx_dmn < bench.m_rank; idx_dmn++)
+        {
+          chunk[idx_dmn] = (idx_dmn >= bench.m_rank - 2) ? std::min(bench.m_chunk, bench.m_dim[idx_dmn]) : 1;
+        }
+        if (nc_def_var_chunking(grp_id, id, NC_CHUNKED, chunk) != NC_NOERR)
+        {
+
+        }
+      }
     }
-    break;
-  case NC_UBYTE:
-    buf = malloc(buf_sz * sizeof(unsigned char));
-    if (nc_get_var_uchar(nc_id, var_id, static_cast<unsigned char *>(buf)) != NC_NOERR)
+    var_id.push_back(id);
+  }
+
+  if ((status = nc_enddef(nc_id)) != NC_NOERR)
+  {
+    nc_close(nc_id);
+    return status;
+  }
+
+  //coordinate values
+  for (int idx_dmn = 0; idx_dmn < bench.m_rank; idx_dmn++)
+  {
+    int crd_id;
+    std::vector<float> crd(bench.m_dim[idx_dmn]);
+    size_t start = 0;
+    size_t count = crd.size();
+    for (size_t idx_crd = 0; idx_crd < crd.size(); idx_crd++)
     {
+      crd[idx_crd] = 0.5f * idx_crd;
     }
-    break;
-  case NC_USHORT:
-    buf = malloc(buf_sz * sizeof(unsigned short));
-    if (nc_get_var_ushort(nc_id, var_id, static_cast<unsigned short *>(buf)) != NC_NOERR)
+    sprintf(dmn_nm, "d%d", idx_dmn);
+    if (nc_inq_varid(grp_id, dmn_nm, &crd_id) != NC_NOERR || nc_put_vara_float(grp_id, crd_id, &start, &count, &crd[0]) != NC_NOERR)
     {
+
     }
-    break;
-  case NC_UINT:
-    buf = malloc(buf_sz * sizeof(unsigned int));
-    if (nc_get_var_uint(nc_id, var_id, static_cast<unsigned int *>(buf)) != NC_NOERR)
+  }
+
+  //values, in slabs of about load_chunk_size elements
+  size_t row_sz = 1;
+  for (int idx_dmn = 1; idx_dmn < bench.m_rank; idx_dmn++)
+  {
+    row_sz *= bench.m_dim[idx_dmn];
+  }
+  size_t nbr_row = bench.m_rank ? bench.m_dim[0] : 1;
+  size_t nbr_row_chunk = std::max<size_t>(1, load_chunk_size / (row_sz * sizeof(double)));
+  for (size_t idx = 0; idx < var_id.size(); idx++)
+  {
+    if (var_id[idx] < 0)
     {
+      continue;
     }
-    break;
-  case NC_INT64:
-    buf = malloc(buf_sz * sizeof(long long));
-    if (nc_get_var_longlong(nc_id, var_id, static_cast<long long *>(buf)) != NC_NOERR)
+    for (size_t idx_row = 0; idx_row < nbr_row; idx_row += nbr_row_chunk)
     {
+      size_t start[NC_MAX_VAR_DIMS];
+      size_t count[NC_MAX_VAR_DIMS];
+      size_t nbr_row_write = std::min(nbr_row_chunk, nbr_row - idx_row);
+      for (int idx_dmn = 0; idx_dmn < bench.m_rank; idx_dmn++)
+      {
+        start[idx_dmn] = 0;
+        count[idx_dmn] = bench.m_dim[idx_dmn];
+      }
+      if (bench.m_rank)
+      {
+        start[0] = idx_row;
+        count[0] = nbr_row_write;
+      }
+      size_t nbr_elm = nbr_row_write * row_sz;
+      if (bench_type[bench.m_type[idx]] == NC_CHAR)
+      {
+        std::vector<char> buf(nbr_elm);
+        for (size_t idx_elm = 0; idx_elm < nbr_elm; idx_elm++)
+        {
+          buf[idx_elm] = 'a' + (idx_row * row_sz + idx_elm) % 26;
+        }
+        status = nc_put_vara_text(grp_id, var_id[idx], start, count, &buf[0]);
+      }
+      else
+      {
+        std::vector<double> buf(nbr_elm);
+        for (size_t idx_elm = 0; idx_elm < nbr_elm; idx_elm++)
+        {
+          buf[idx_elm] = (idx_row * row_sz + idx_elm) % 100;
+        }
+        status = nc_put_vara_double(grp_id, var_id[idx], start, count, &buf[0]);
+      }
+      if (status != NC_NOERR)
+      {
+        nc_close(nc_id);
+        return status;
+      }
     }
-    break;
-  case NC_UINT64:
-    buf = malloc(buf_sz * sizeof(unsigned long long));
-    if (nc_get_var_ulonglong(nc_id, var_id, static_cast<unsigned long long *>(buf)) != NC_NOERR)
+  }
+
+  return nc_close(nc_id);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//BenchIterate
+//scan a group and its sub-groups, as opening a file and expanding all groups
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int BenchIterate(const wxString& file_name, const wxString& grp_nm_fll)
+{
+  int nc_id;
+  int grp_id;
+  int status;
+  ncgrp_t grp;
+  if ((status = OpenGroup(file_name.mb_str(), grp_nm_fll.mb_str(), &nc_id, &grp_id)) != NC_NOERR)
+  {
+    return status;
+  }
+  if ((status = wxFrameExplorer::ScanGroup(grp_id, grp)) != NC_NOERR)
+  {
+    return status;
+  }
+  for (size_t idx_grp = 0; idx_grp < grp.m_grp_nm.size(); idx_grp++)
+  {
+    wxString grp_nm_fll_sub(grp_nm_fll);
+    if (grp_nm_fll_sub != "/")
     {
+      grp_nm_fll_sub += "/";
     }
-    break;
-  case NC_STRING:
-    buf = malloc(buf_sz * sizeof(char*));
-    if (nc_get_var_string(nc_id, var_id, static_cast<char* *>(buf)) != NC_NOERR)
+    grp_nm_fll_sub += grp.m_grp_nm[idx_grp];
+    if ((status = BenchIterate(file_name, grp_nm_fll_sub)) != NC_NOERR)
     {
+      return status;
     }
-    break;
   }
-  return buf;
+  return NC_NOERR;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxGridLayers::ShowGrid
+//BenchFormatPrintf
+//format element as with wxString::Format and GetFormat, for comparison
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class bench_printf_t
+{
+public:
+  bench_printf_t(nc_type nc_typ, size_t idx) :
+    m_format(wxGridLayers::GetFormat(nc_typ)),
+    m_idx(idx)
+  {
+  }
+  template <typename T>
+  void operator()(const T *buf)
+  {
+    m_str = wxString::Format(m_format, buf[m_idx]);
+  }
+  wxString m_format;
+  size_t m_idx;
+  wxString m_str;
+};
+
+wxString BenchFormatPrintf(const ncvar_t *ncvar, size_t idx)
+{
+  bench_printf_t visitor(ncvar->m_nc_type, idx);
+  nc_visit(ncvar->m_nc_type, static_cast<const void*>(ncvar->m_buf), visitor);
+  return visitor.m_str;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+//BenchFile
+//time cases on a generated file
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxGridLayers::ShowGrid()
-{
-  size_t idx_buf = 0;
-  //3D
-  if (m_layer.size() == 1)
+int BenchFile(bench_t &bench, const char *fmt, const wxString &file_name, const wxString &grp_nm_fll, bool nc4)
+{
+  int status;
+  int nc_id;
+  int grp_id;
+  int var_id;
+  ncgrp_t grp;
+  wxStopWatch watch;
+
+  //open and iterate (closed each time)
+  watch.Start();
+  for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
+  {
+    nc_pool.close_all();
+    if ((status = BenchIterate(file_name, "/")) != NC_NOERR)
+    {
+      return status;
+    }
+  }
+  bench.Result(fmt, -1, "open_iterate", static_cast<double>(watch.Time()) / bench.m_repeat, 0);
+  bench.Memory(fmt, "intern_names", nc_intern_table().memory());
+
+  if ((status = OpenGroup(file_name.mb_str(), grp_nm_fll.mb_str(), &nc_id, &grp_id)) != NC_NOERR ||
+    (status = wxFrameExplorer::ScanGroup(grp_id, grp)) != NC_NOERR)
   {
-    idx_buf = m_layer[0] * m_nbr_rows * m_nbr_cols;
+    return status;
   }
-  //4D
-  else if (m_layer.size() == 2)
+  wxItemData item_data_grp(wxItemData::Group, file_name.mb_str(), grp_nm_fll.mb_str(), grp_nm_fll.mb_str(), (wxItemData*)NULL,
+    (ncvar_t*)NULL, (grid_policy_t*)NULL);
+  for (size_t idx_var = 0; idx_var < grp.m_ncvar.size(); idx_var++)
   {
-    idx_buf = m_layer[0] * m_ncvar->m_ncdim[1].m_size + m_layer[1];
-    idx_buf *= m_nbr_rows * m_nbr_cols;
+    item_data_grp.m_var_ids[grp.m_ncvar[idx_var]->m_name] = static_cast<int>(idx_var);
   }
-  //5D
-  else if (m_layer.size() == 3)
+
+  for (size_t idx = 0; idx < bench.m_type.size(); idx++)
   {
-    idx_buf = m_layer[0] * m_ncvar->m_ncdim[1].m_size * m_ncvar->m_ncdim[2].m_size
-      + m_layer[1] * m_ncvar->m_ncdim[2].m_size
-      + m_layer[2];
-    idx_buf *= m_nbr_rows * m_nbr_cols;
-  }
-  float *buf_float = NULL;
-  double *buf_double = NULL;
-  int *buf_int = NULL;
-  short *buf_short = NULL;
-  char *buf_char = NULL;
-  signed char *buf_byte = NULL;
-  unsigned char *buf_ubyte = NULL;
-  unsigned short *buf_ushort = NULL;
-  unsigned int *buf_uint = NULL;
-  long long *buf_int64 = NULL;
-  unsigned long long *buf_uint64 = NULL;
-  char* *buf_string = NULL;
+    int idx_typ = bench.m_type[idx];
+    if (!nc4 && idx_typ >= bench_nbr_type_nc3)
+    {
+      continue;
+    }
+    nc_type typ = bench_type[idx_typ];
+    size_t nbr_byt = bench.m_size * nc_type_size(typ);
+    std::vector<ncdim_t> ncdim;
+    for (int idx_dmn = 0; idx_dmn < bench.m_rank; idx_dmn++)
+    {
+      ncdim.push_back(ncdim_t(wxString::Format("d%d", idx_dmn).mb_str(), bench.m_dim[idx_dmn]));
+    }
 
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
-  //labels for columns
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
+    //LoadItem, coordinates and variable (unless read by layers), from a new item each time
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
+    {
+      wxItemData item_data(wxItemData::Variable, file_name.mb_str(), grp_nm_fll.mb_str(), bench_type_nm[idx_typ], &item_data_grp,
+        new ncvar_t(bench_type_nm[idx_typ], typ, ncdim), new grid_policy_t(ncdim));
+      wxTreeCtrlExplorer::LoadItem(&item_data);
+    }
+    bench.Result(fmt, idx_typ, "load_item", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_byt);
 
-  //columns not defined
-  if (m_dim_cols == -1)
-  {
-    assert(m_nbr_cols == 1);
-    this->SetColLabelValue(0, wxString::Format(wxT("%d"), 1));
-  }
-  else
-  {
-    //coordinate variable exists
-    if (m_ncvar_crd[m_dim_cols] != NULL)
+    //LoadVariable, whole variable
+    if ((status = nc_inq_varid(grp_id, bench_type_nm[idx_typ], &var_id)) != NC_NOERR)
     {
-      switch (m_ncvar_crd[m_dim_cols]->m_nc_type)
-      {
-      case NC_FLOAT:
-        buf_float = static_cast<float*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_FLOAT), buf_float[idx_col]));
-        }
-        break;
-      case NC_DOUBLE:
-        buf_double = static_cast<double*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_DOUBLE), buf_double[idx_col]));
-        }
-        break;
-      case NC_INT:
-        buf_int = static_cast<int*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_INT), buf_int[idx_col]));
-        }
-        break;
-      case NC_SHORT:
-        buf_short = static_cast<short*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_SHORT), buf_short[idx_col]));
-        }
-        break;
-      case NC_BYTE:
-        buf_byte = static_cast<signed char*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_BYTE), buf_byte[idx_col]));
-        }
-        break;
-      case NC_UBYTE:
-        buf_ubyte = static_cast<unsigned char*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_UBYTE), buf_ubyte[idx_col]));
-        }
-        break;
-      case NC_USHORT:
-        buf_ushort = static_cast<unsigned short*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_USHORT), buf_ushort[idx_col]));
-        }
-        break;
-      case NC_UINT:
-        buf_uint = static_cast<unsigned int*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_UINT), buf_uint[idx_col]));
-        }
-        break;
-      case NC_INT64:
-        buf_int64 = static_cast<long long*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_INT64), buf_int64[idx_col]));
-        }
-        break;
-      case NC_UINT64:
-        buf_uint64 = static_cast<unsigned long long*> (m_ncvar_crd[m_dim_cols]->m_buf);
-        for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-        {
-          this->SetColLabelValue(idx_col, wxString::Format(GetFormat(NC_UINT64), buf_uint64[idx_col]));
-        }
-        break;
-      }//switch  
+      return status;
     }
-    //coordinate variable does not exist
-    else
+    ncvar_t ncvar(bench_type_nm[idx_typ], typ, ncdim);
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
+      ncbuf_t buf;
+      ncvar.release();
+      if ((status = wxTreeCtrlExplorer::LoadVariable(grp_id, var_id, typ, bench.m_size, buf)) != NC_NOERR)
       {
-        this->SetColLabelValue(idx_col, wxString::Format(wxT("%d"), idx_col + 1));
+        return status;
       }
+      ncvar.store(std::move(buf));
     }
-  }
+    bench.Result(fmt, idx_typ, "load_variable", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_byt);
 
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
-  //labels for rows
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
-
-  //rows not defined
-  if (m_dim_rows == -1)
-  {
-    this->SetRowLabelValue(0, wxString::Format(wxT("%d"), 1));
-  }
-  else
-  {
-    //coordinate variable exists
-    if (m_ncvar_crd[m_dim_rows] != NULL)
+    //classic format mapped in memory (--mmap), whole variable copied to native order
+    if (!nc4)
     {
-      switch (m_ncvar_crd[m_dim_rows]->m_nc_type)
+      std::vector<size_t> start(ncdim.size(), 0);
+      std::vector<size_t> count;
+      for (size_t idx_dmn = 0; idx_dmn < ncdim.size(); idx_dmn++)
       {
-      case NC_FLOAT:
-        buf_float = static_cast<float*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_FLOAT), buf_float[idx_row]));
-        }
-        break;
-      case NC_DOUBLE:
-        buf_double = static_cast<double*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_DOUBLE), buf_double[idx_row]));
-        }
-        break;
-      case NC_INT:
-        buf_int = static_cast<int*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_INT), buf_int[idx_row]));
-        }
-        break;
-      case NC_SHORT:
-        buf_short = static_cast<short*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_SHORT), buf_short[idx_row]));
-        }
-        break;
-      case NC_BYTE:
-        buf_byte = static_cast<signed char*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_BYTE), buf_byte[idx_row]));
-        }
-        break;
-      case NC_UBYTE:
-        buf_ubyte = static_cast<unsigned char*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_UBYTE), buf_ubyte[idx_row]));
-        }
-        break;
-      case NC_USHORT:
-        buf_ushort = static_cast<unsigned short*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-        {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_USHORT), buf_ushort[idx_row]));
-        }
-        break;
-      case NC_UINT:
-        buf_uint = static_cast<unsigned int*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+        count.push_back(ncdim[idx_dmn].m_size);
+      }
+      std::vector<char> buf(nbr_byt);
+      watch.Start();
+      for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
+      {
+        ncmmap_t mmap;
+        const ncmmap_var_t *mmap_var;
+        if ((status = mmap.open(file_name.mb_str())) != NC_NOERR)
         {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_UINT), buf_uint[idx_row]));
+          return status;
         }
-        break;
-      case NC_INT64:
-        buf_int64 = static_cast<long long*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+        if ((mmap_var = mmap.find(bench_type_nm[idx_typ])) == NULL)
         {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_INT64), buf_int64[idx_row]));
+          return NC_ENOTVAR;
         }
-        break;
-      case NC_UINT64:
-        buf_uint64 = static_cast<unsigned long long*> (m_ncvar_crd[m_dim_rows]->m_buf);
-        for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+        if ((status = mmap.read(*mmap_var, count.empty() ? NULL : &start[0], count.empty() ? NULL : &count[0], &buf[0])) != NC_NOERR)
         {
-          this->SetRowLabelValue(idx_row, wxString::Format(GetFormat(NC_UINT64), buf_uint64[idx_row]));
+          return status;
         }
-        break;
-      }//switch
-    }
-    //coordinate variable does not exist
-    else
-    {
-      for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
-      {
-        this->SetRowLabelValue(idx_row, wxString::Format(wxT("%d"), idx_row + 1));
       }
+      bench.Result(fmt, idx_typ, "load_mmap", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_byt);
     }
-  }
 
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
-  //grid
-  /////////////////////////////////////////////////////////////////////////////////////////////////////
-
-  switch (m_ncvar->m_nc_type)
-  {
-  case NC_FLOAT:
-    buf_float = static_cast<float*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    //format first layer (rows and columns of the grid policy), as the grid table for each cell
+    grid_policy_t grid_policy(ncdim);
+    size_t nbr_cell = 1;
+    if (grid_policy.m_dim_rows >= 0)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_FLOAT), buf_float[idx_buf]));
-        idx_buf++;
-      }
+      nbr_cell *= bench.m_dim[grid_policy.m_dim_rows];
     }
-    break;
-  case NC_DOUBLE:
-    buf_double = static_cast<double*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    if (grid_policy.m_dim_cols >= 0)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_DOUBLE), buf_double[idx_buf]));
-        idx_buf++;
-      }
+      nbr_cell *= bench.m_dim[grid_policy.m_dim_cols];
     }
-    break;
-  case NC_INT:
-    buf_int = static_cast<int*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    //printf format parsed for each cell (as before ncformat_t)
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
+      for (size_t idx_cell = 0; idx_cell < nbr_cell; idx_cell++)
       {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_INT), buf_int[idx_buf]));
-        idx_buf++;
+        wxString value = BenchFormatPrintf(&ncvar, idx_cell);
       }
     }
-    break;
-  case NC_SHORT:
-    buf_short = static_cast<short*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "format_printf", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+
+    //formatter for each cell, as the grid table
+    ncformat_t format(typ);
+    std::string str;
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
+      for (size_t idx_cell = 0; idx_cell < nbr_cell; idx_cell++)
       {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_SHORT), buf_short[idx_buf]));
-        idx_buf++;
+        str.clear();
+        format.append(ncvar.m_buf, idx_cell, str);
+        wxString value(str.c_str(), str.size());
       }
     }
-    break;
-  case NC_CHAR:
-    buf_char = static_cast<char*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "format_layer", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+
+    //whole layer into an arena, in parallel, as the batch mode
+    ncarena_t arena;
+    std::vector<ncarena_t> parts;
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_CHAR), buf_char[idx_buf]));
-        idx_buf++;
-      }
+      arena.clear();
+      nc_format_parallel(format, ncvar.m_buf, 0, nbr_cell, arena, parts);
     }
-    break;
-  case NC_BYTE:
-    buf_byte = static_cast<signed char*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "format_arena", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+
+    //statistics of the whole variable, resident (as a view of a loaded variable) and streamed from file
+    if (!nc_is_numeric(typ))
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_BYTE), buf_byte[idx_buf]));
-        idx_buf++;
-      }
+      continue;
     }
-    break;
-  case NC_UBYTE:
-    buf_ubyte = static_cast<unsigned char*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    std::vector<unsigned char> fill;
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_UBYTE), buf_ubyte[idx_buf]));
-        idx_buf++;
-      }
+      ncstats_t stats;
+      nc_stats_parallel(typ, ncvar.m_buf, bench.m_size, fill, stats);
     }
-    break;
-  case NC_USHORT:
-    buf_ushort = static_cast<unsigned short*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "stats", static_cast<double>(watch.Time()) / bench.m_repeat, bench.m_size);
+
+    //search of the whole variable, resident (as the Find tool of a view of a loaded variable)
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_USHORT), buf_ushort[idx_buf]));
-        idx_buf++;
-      }
+      std::vector<size_t> hits;
+      nc_find_parallel(typ, ncvar.m_buf, bench.m_size, fill, ncfind_t(nc_find_range, 10, 20), 0, max_find_hits, hits);
     }
-    break;
-  case NC_UINT:
-    buf_uint = static_cast<unsigned int*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "find", static_cast<double>(watch.Time()) / bench.m_repeat, bench.m_size);
+    wxItemData item_data(wxItemData::Variable, file_name, grp_nm_fll, bench_type_nm[idx_typ], &item_data_grp,
+      new ncvar_t(bench_type_nm[idx_typ], typ, ncdim), new grid_policy_t(ncdim));
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
+      ncload_t load(&item_data);
+      ncstats_t stats;
+      if ((status = StatsLoad(&load, fill, ncpack_t(), stats)) != NC_NOERR)
       {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_UINT), buf_uint[idx_buf]));
-        idx_buf++;
+        return status;
       }
     }
-    break;
-  case NC_INT64:
-    buf_int64 = static_cast<long long*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "stats_stream", static_cast<double>(watch.Time()) / bench.m_repeat, bench.m_size);
+
+    //first layer unpacked (scale_factor, add_offset, _FillValue, valid_range), as a view of a packed variable
+    ncpack_t pack;
+    pack.m_nc_type = NC_FLOAT;
+    pack.m_scale = 0.01;
+    pack.m_offset = 10;
+    pack.m_has_fill = true;
+    pack.m_fill = 1;
+    pack.m_valid_min = 0;
+    pack.m_valid_max = 100;
+    std::vector<float> buf_unpack(nbr_cell);
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_INT64), buf_int64[idx_buf]));
-        idx_buf++;
-      }
+      nc_unpack_parallel(typ, ncvar.m_buf, nbr_cell, pack, &buf_unpack[0]);
     }
-    break;
-  case NC_UINT64:
-    buf_uint64 = static_cast<unsigned long long*> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "unpack", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+
+    //first layer rendered to an image, as the image view
+    const int bench_image_size = 1024; //pixels
+    nccolormap_t colormap;
+    std::vector<unsigned char> rgb(bench_image_size * bench_image_size * 3);
+    size_t nbr_rows = (grid_policy.m_dim_rows >= 0) ? bench.m_dim[grid_policy.m_dim_rows] : 1;
+    size_t nbr_cols = nbr_cell / nbr_rows;
+    ncview_t view(nbr_rows, nbr_cols, bench_image_size, bench_image_size);
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_UINT64), buf_uint64[idx_buf]));
-        idx_buf++;
-      }
+      nc_render_parallel(typ, ncvar.m_buf, nbr_rows, nbr_cols, fill, 0, 100, colormap,
+        view, bench_image_size, bench_image_size, &rgb[0]);
     }
-    break;
-  case NC_STRING:
-    buf_string = static_cast<char**> (m_ncvar->m_buf);
-    for (int idx_row = 0; idx_row < m_nbr_rows; idx_row++)
+    bench.Result(fmt, idx_typ, "render", static_cast<double>(watch.Time()) / bench.m_repeat, bench_image_size * bench_image_size);
+
+    //all pyramid levels of the first layer, built as the image view on first zoom out
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
     {
-      for (int idx_col = 0; idx_col < m_nbr_cols; idx_col++)
-      {
-        this->SetCellValue(idx_row, idx_col, wxString::Format(GetFormat(NC_STRING), buf_string[idx_buf]));
-        idx_buf++;
-      }
+      ncpyramid_t pyramid(typ, nbr_rows, nbr_cols, fill);
+      pyramid.level(pyramid.size(), ncvar.m_buf);
     }
-    break;
-  }//switch
+    bench.Result(fmt, idx_typ, "pyramid", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+
+    //first layer copied to rows x columns as stored, and with rows and columns swapped (Dimensions)
+    std::vector<char> layer(std::max<size_t>(nbr_cell, 1) * nc_type_size(typ));
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
+    {
+      nc_transpose_parallel(typ, ncvar.m_buf, 0, nbr_cols, 1, nbr_rows, nbr_cols, &layer[0]);
+    }
+    bench.Result(fmt, idx_typ, "layer_copy", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+    watch.Start();
+    for (int idx_rpt = 0; idx_rpt < bench.m_repeat; idx_rpt++)
+    {
+      nc_transpose_parallel(typ, ncvar.m_buf, 0, 1, nbr_cols, nbr_cols, nbr_rows, &layer[0]);
+    }
+    bench.Result(fmt, idx_typ, "layer_transpose", static_cast<double>(watch.Time()) / bench.m_repeat, nbr_cell);
+  }
+  return NC_NOERR;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxGridLayers::GetFormat
-//Provide sprintf() format string for specified netCDF type
-//Based on NCO utilities
+//BenchMain
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-wxString wxGridLayers::GetFormat(const nc_type typ)
+int BenchMain(int argc, char **argv)
 {
-  const char fmt_NC_FLOAT[] = "%g";
-  const char fmt_NC_DOUBLE[] = "%.12g";
-  const char fmt_NC_INT[] = "%i";
-  const char fmt_NC_SHORT[] = "%hi";
-  const char fmt_NC_CHAR[] = "%c";
-  const char fmt_NC_BYTE[] = "%hhi";
-  const char fmt_NC_UBYTE[] = "%hhu";
-  const char fmt_NC_USHORT[] = "%hu";
-  const char fmt_NC_UINT[] = "%u";
-  const char fmt_NC_INT64[] = "%lli";
-  const char fmt_NC_UINT64[] = "%llu";
-  const char fmt_NC_STRING[] = "%s";
-  switch (typ)
+  bench_t bench;
+  long val;
+  wxString str;
+  wxString dir(".");
+  wxString fmt("nc3,nc4");
+
+  wxMessageOutput::Set(new wxMessageOutputStderr);
+  wxCmdLineParser parser(argc, argv);
+  parser.AddSwitch("h", "help", "show this help message", wxCMD_LINE_OPTION_HELP);
+  parser.AddOption("s", "size", "elements per variable (default 1048576)", wxCMD_LINE_VAL_NUMBER);
+  parser.AddOption("r", "rank", "dimensions per variable (default 3)", wxCMD_LINE_VAL_NUMBER);
+  parser.AddOption("t", "type", "types to generate, comma separated (default all)");
+  parser.AddOption("k", "chunk", "netCDF-4 chunk size of rows and columns (default contiguous)", wxCMD_LINE_VAL_NUMBER);
+  parser.AddOption("g", "depth", "netCDF-4 group depth of variables (default 0)", wxCMD_LINE_VAL_NUMBER);
+  parser.AddOption("f", "format", "formats to generate, nc3,nc4 (default both)");
+  parser.AddOption("n", "repeat", "times each case is run (default 3)", wxCMD_LINE_VAL_NUMBER);
+  parser.AddOption("d", "dir", "directory for generated files (default .)");
+  parser.AddOption("o", "output", "CSV results file (default stdout)");
+  if (parser.Parse() != 0)
   {
-  case NC_FLOAT:
-    return  wxString::FromAscii(fmt_NC_FLOAT);
-  case NC_DOUBLE:
-    return wxString::FromAscii(fmt_NC_DOUBLE);
-  case NC_INT:
-    return wxString::FromAscii(fmt_NC_INT);
-  case NC_SHORT:
-    return wxString::FromAscii(fmt_NC_SHORT);
-  case NC_CHAR:
-    return wxString::FromAscii(fmt_NC_CHAR);
-  case NC_BYTE:
-    return wxString::FromAscii(fmt_NC_BYTE);
-  case NC_UBYTE:
-    return wxString::FromAscii(fmt_NC_UBYTE);
-  case NC_USHORT:
-    return wxString::FromAscii(fmt_NC_USHORT);
-  case NC_UINT:
-    return wxString::FromAscii(fmt_NC_UINT);
-  case NC_INT64:
-    return wxString::FromAscii(fmt_NC_INT64);
-  case NC_UINT64:
-    return wxString::FromAscii(fmt_NC_UINT64);
-  case NC_STRING:
-    return wxString::FromAscii(fmt_NC_STRING);
+    return 1;
   }
-  return wxString::FromAscii("");
-}
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::OnItemMenu
-/////////////////////////////////////////////////////////////////////////////////////////////////////
+  if (parser.Found("size", &val) && val > 0)
+  {
+    bench.m_size = static_cast<size_t>(val);
+  }
+  if (parser.Found("rank", &val) && val >= 0 && val <= NC_MAX_VAR_DIMS)
+  {
+    bench.m_rank = static_cast<int>(val);
+  }
+  if (parser.Found("chunk", &val) && val >= 0)
+  {
+    bench.m_chunk = static_cast<size_t>(val);
+  }
+  if (parser.Found("depth", &val) && val >= 0)
+  {
+    bench.m_depth = static_cast<int>(val);
+  }
+  if (parser.Found("repeat", &val) && val > 0)
+  {
+    bench.m_repeat = static_cast<int>(val);
+  }
+  parser.Found("dir", &dir);
+  parser.Found("format", &fmt);
+  if (parser.Found("type", &str))
+  {
+    str = "," + str + ",";
+    for (int idx_typ = 0; idx_typ < bench_nbr_type; idx_typ++)
+    {
+      if (str.Find(wxString::Format(",%s,", bench_type_nm[idx_typ])) != wxNOT_FOUND)
+      {
+        bench.m_type.push_back(idx_typ);
+      }
+    }
+  }
+  else
+  {
+    for (int idx_typ = 0; idx_typ < bench_nbr_type; idx_typ++)
+    {
+      bench.m_type.push_back(idx_typ);
+    }
+  }
+  if (parser.Found("output", &str))
+  {
+    if ((bench.m_out = fopen(str.mb_str(), "w")) == NULL)
+    {
+      fprintf(stderr, "cannot write %s\n", static_cast<const char*>(str.mb_str()));
+      return 1;
+    }
+  }
 
-void wxTreeCtrlExplorer::OnItemMenu(wxTreeEvent& event)
-{
-  wxMenu menu;
-  wxTreeItemId item_id = event.GetItem();
-  this->SetFocusedItem(item_id);
-  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
-  if (item_data->m_kind != wxItemData::Variable)
+  //dimensions of equal size, product about m_size
+  size_t side = bench.m_rank ? static_cast<size_t>(pow(static_cast<double>(bench.m_size), 1.0 / bench.m_rank) + 0.5) : 1;
+  side = std::max<size_t>(1, side);
+  bench.m_size = 1;
+  for (int idx_dmn = 0; idx_dmn < bench.m_rank; idx_dmn++)
   {
-    return;
+    bench.m_dim.push_back(side);
+    bench.m_size *= side;
   }
-  menu.Append(ID_TREE_LOAD_ITEM, wxT("&Show"));
-  PopupMenu(&menu, event.GetPoint());
-  event.Skip();
+
+  fprintf(bench.m_out, "format,type,rank,size,chunk,depth,case,ms,count,rate\n");
+  int ret = 0;
+  for (int idx_fmt = 0; idx_fmt < 2; idx_fmt++)
+  {
+    const char *fmt_nm = idx_fmt ? "nc4" : "nc3";
+    if (fmt.Find(fmt_nm) == wxNOT_FOUND)
+    {
+      continue;
+    }
+    wxString file_name = dir + "/bench_explorer_" + fmt_nm + ".nc";
+    wxString grp_nm_fll;
+    int status;
+    if ((status = BenchCreate(bench, file_name.mb_str(), idx_fmt == 1, grp_nm_fll)) != NC_NOERR ||
+      (status = BenchFile(bench, fmt_nm, file_name, grp_nm_fll, idx_fmt == 1)) != NC_NOERR)
+    {
+      fprintf(stderr, "%s: %s\n", static_cast<const char*>(file_name.mb_str()), nc_strerror(status));
+      ret = 1;
+    }
+    nc_pool.close_all();
+  }
+
+  if (bench.m_out != stdout)
+  {
+    fclose(bench.m_out);
+  }
+  return ret;
 }
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
-//wxTreeCtrlExplorer::OnLoadItem
+//main
+//batch mode runs before wxWidgets is initialized (no display needed)
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void wxTreeCtrlExplorer::OnLoadItem(wxCommandEvent& WXUNUSED(event))
+int main(int argc, char **argv)
 {
-  wxTreeItemId item_id = this->GetFocusedItem();
-  wxItemData *item_data = (wxItemData *)GetItemData(item_id);
-  assert(item_data->m_kind == wxItemData::Variable);
-  ShowVariable(item_data);
+#ifdef BENCH_EXPLORER
+  return BenchMain(argc, argv);
+#else
+  if (IsBatch(argc, argv))
+  {
+    return BatchMain(argc, argv);
+  }
+  return wxEntry(argc, argv);
+#endif
 }
-
-
-
-